@@ -0,0 +1,78 @@
+#include "codec.hpp"
+#include <limits>
+#include <zlib.h>
+
+
+namespace
+{
+    struct deflate_stream
+    {
+        deflate_stream() { is_ready_ = (deflateInit(&stream_, Z_DEFAULT_COMPRESSION) == Z_OK); }
+        ~deflate_stream() { if (is_ready_) { deflateEnd(&stream_); } }
+
+        z_stream stream_ = {};
+        bool is_ready_ = false;
+        int level_ = Z_DEFAULT_COMPRESSION;
+    };
+
+    struct inflate_stream
+    {
+        inflate_stream() { is_ready_ = (inflateInit(&stream_) == Z_OK); }
+        ~inflate_stream() { if (is_ready_) { inflateEnd(&stream_); } }
+
+        z_stream stream_ = {};
+        bool is_ready_ = false;
+    };
+}
+
+
+networking::zlib_codec::zlib_codec(const int& level) :
+    level_(level)
+{
+
+}
+
+
+std::size_t networking::zlib_codec::bound(const std::size_t& size) const
+{
+    return compressBound(static_cast<uLong>(size));
+}
+
+
+std::size_t networking::zlib_codec::compress(const unsigned char* const source, const std::size_t& size, 
+    unsigned char* const destination, const std::size_t& capacity) const
+{
+    thread_local deflate_stream deflater;
+    if (size > std::numeric_limits<uInt>::max() || capacity > std::numeric_limits<uInt>::max()) { return 0; }
+    if (!deflater.is_ready_ || deflateReset(&deflater.stream_) != Z_OK) { return 0; }
+
+    if (deflater.level_ != level_)
+    {
+        if (deflateParams(&deflater.stream_, level_, Z_DEFAULT_STRATEGY) != Z_OK) { return 0; }
+        deflater.level_ = level_;
+    }
+
+    deflater.stream_.next_in = const_cast<Bytef*>(source);
+    deflater.stream_.avail_in = static_cast<uInt>(size);
+    deflater.stream_.next_out = destination;
+    deflater.stream_.avail_out = static_cast<uInt>(capacity);
+
+    if (deflate(&deflater.stream_, Z_FINISH) != Z_STREAM_END) { return 0; }
+    return deflater.stream_.total_out;
+}
+
+
+bool networking::zlib_codec::decompress(const unsigned char* const source, const std::size_t& size, 
+    unsigned char* const destination, const std::size_t& original_size) const
+{
+    thread_local inflate_stream inflater;
+    if (size > std::numeric_limits<uInt>::max() || original_size > std::numeric_limits<uInt>::max()) { return false; }
+    if (!inflater.is_ready_ || inflateReset(&inflater.stream_) != Z_OK) { return false; }
+
+    inflater.stream_.next_in = const_cast<Bytef*>(source);
+    inflater.stream_.avail_in = static_cast<uInt>(size);
+    inflater.stream_.next_out = destination;
+    inflater.stream_.avail_out = static_cast<uInt>(original_size);
+
+    return (inflate(&inflater.stream_, Z_FINISH) == Z_STREAM_END && inflater.stream_.total_out == original_size);
+}
@@ -0,0 +1,66 @@
+#ifndef __NETWORKING_CODEC_HPP__
+#define __NETWORKING_CODEC_HPP__
+#include <cinttypes>
+#include <cstddef>
+
+
+namespace networking
+{
+    // Payload compressor selected per frame by the id carried in the frame header, so both
+    // ends must register the same codec under the same id (1 to 15).
+    class codec
+    {
+        public:
+            codec() = default;
+            codec(const codec& obj) = delete;
+            codec(codec&& obj) = delete;
+            virtual ~codec() = default;
+
+            codec& operator=(const codec& obj) = delete;
+            codec& operator=(codec&& obj) = delete;
+
+            virtual std::uint8_t id() const = 0;
+            virtual std::size_t bound(const std::size_t& size) const = 0;
+            virtual std::size_t compress(const unsigned char* const source, const std::size_t& size, 
+                unsigned char* const destination, const std::size_t& capacity) const = 0;
+            virtual bool decompress(const unsigned char* const source, const std::size_t& size, 
+                unsigned char* const destination, const std::size_t& original_size) const = 0;
+    };
+
+
+    // Deflate from the system zlib. Each thread keeps its own stream, which is only reset
+    // between messages instead of being set up again.
+    class zlib_codec : public codec
+    {
+        public:
+            static constexpr std::uint8_t ID = 1;
+
+            zlib_codec(const int& level = 1);
+
+            std::uint8_t id() const override;
+            std::size_t bound(const std::size_t& size) const override;
+            std::size_t compress(const unsigned char* const source, const std::size_t& size, 
+                unsigned char* const destination, const std::size_t& capacity) const override;
+            bool decompress(const unsigned char* const source, const std::size_t& size, 
+                unsigned char* const destination, const std::size_t& original_size) const override;
+            int level() const;
+
+
+        private:
+            int level_ = 1;
+    };
+}
+
+
+inline std::uint8_t networking::zlib_codec::id() const
+{
+    return ID;
+}
+
+inline int networking::zlib_codec::level() const
+{
+    return level_;
+}
+
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef __NETWORKING_FRAME_HEADER_HPP__
+#define __NETWORKING_FRAME_HEADER_HPP__
+#include <cinttypes>
+#include <cstddef>
+
+
+namespace networking
+{
+    // Length prefix of every framed message, big-endian and always as short as the length allows:
+    //   0xxxxxxx                   1 byte,  lengths up to 127
+    //   10xxxxxx + 1 byte          2 bytes, lengths up to 16383
+    //   110xxxxx + 3 bytes         4 bytes, lengths up to 2^29 - 1
+    //   11111111 + 8 bytes         9 bytes, any 64-bit length
+    // A 1110cccc byte before the header marks a payload compressed with codec c (1 to 15), which
+    // starts with a second header holding the original length. The remaining 111xxxxx prefixes
+    // are reserved for later header versions and are rejected.
+    class frame_header
+    {
+        public:
+            static constexpr std::size_t MAX_SIZE = 9;
+            static constexpr unsigned char CODEC_PREFIX = 0xE0;
+            static constexpr std::uint8_t CODECS_COUNT = 16;
+
+            frame_header() = delete;
+
+            static std::size_t encoded_size(const std::uint64_t& length);
+            static std::size_t size(const unsigned char& first);
+            static std::size_t encode(const std::uint64_t& length, unsigned char* const header);
+            static std::uint64_t decode(const unsigned char* const header);
+            static std::uint8_t codec(const unsigned char& first);
+    };
+}
+
+
+inline std::size_t networking::frame_header::encoded_size(const std::uint64_t& length)
+{
+    if (length < (1ULL << 7)) { return 1; }
+    else if (length < (1ULL << 14)) { return 2; }
+    else if (length < (1ULL << 29)) { return 4; }
+    return MAX_SIZE;
+}
+
+inline std::size_t networking::frame_header::size(const unsigned char& first)
+{
+    if (first < 0x80) { return 1; }
+    else if (first < 0xC0) { return 2; }
+    else if (first < 0xE0) { return 4; }
+    else if (first == 0xFF) { return MAX_SIZE; }
+    return 0;
+}
+
+inline std::size_t networking::frame_header::encode(const std::uint64_t& length, unsigned char* const header)
+{
+    const std::size_t header_size = encoded_size(length);
+    const std::size_t length_size = (header_size == MAX_SIZE) ? 8 : header_size;
+    unsigned char* const length_bytes = header + (header_size - length_size);
+
+    for (std::size_t i = 0; i < length_size; ++i) {
+        length_bytes[i] = static_cast<unsigned char>(length >> (8 * (length_size - i - 1)));
+    }
+
+    if (header_size == 2) { header[0] |= 0x80; }
+    else if (header_size == 4) { header[0] |= 0xC0; }
+    else if (header_size == MAX_SIZE) { header[0] = 0xFF; }
+
+    return header_size;
+}
+
+inline std::uint64_t networking::frame_header::decode(const unsigned char* const header)
+{
+    const std::size_t header_size = size(header[0]);
+    if (header_size == MAX_SIZE)
+    {
+        std::uint64_t length = 0;
+        for (std::size_t i = 1; i < MAX_SIZE; ++i) { length = (length << 8) | header[i]; }
+        return length;
+    }
+
+    std::uint64_t length = header[0] & ((header_size == 1) ? 0x7F : (header_size == 2) ? 0x3F : 0x1F);
+    for (std::size_t i = 1; i < header_size; ++i) { length = (length << 8) | header[i]; }
+    return length;
+}
+
+inline std::uint8_t networking::frame_header::codec(const unsigned char& first)
+{
+    return ((first & 0xF0) == CODEC_PREFIX) ? (first & 0x0F) : 0;
+}
+
+
+#endif
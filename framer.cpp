@@ -0,0 +1,288 @@
+#include "framer.hpp"
+#include "frame_header.hpp"
+#include "networking_error.hpp"
+#include <algorithm>
+#include <cstring>
+
+
+networking::framer::framer(const std::size_t& max_frame_size) :
+    max_frame_size_(max_frame_size)
+{
+
+}
+
+
+bool networking::framer::wrap_compressed(const std::size_t& size, const std::uint8_t& codec, 
+    networking::framer::envelope& frame) const
+{
+    return false;
+}
+
+
+bool networking::framer::is_payload_encoded() const
+{
+    return false;
+}
+
+
+void networking::framer::reset()
+{
+    begin_ = 0;
+    end_ = 0;
+    front_ = networking::framer::bounds();
+    is_front_ = false;
+}
+
+
+unsigned char* networking::framer::prepare(const std::size_t& size)
+{
+    if (buffer_.size() - end_ < size)
+    {
+        if (begin_ > 0)
+        {
+            std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+            end_ -= begin_;
+            begin_ = 0;
+        }
+
+        if (buffer_.size() - end_ < size) { buffer_.resize(end_ + size); }
+    }
+
+    return buffer_.data() + end_;
+}
+
+
+void networking::framer::commit(const std::size_t& size)
+{
+    end_ = std::min(end_ + size, buffer_.size());
+}
+
+
+bool networking::framer::commit(const std::size_t& size, const networking::framer::frame_callback& on_frame)
+{
+    commit(size);
+
+    unsigned char* payload = nullptr;
+    std::size_t payload_size = 0;
+    networking::framer::status result;
+
+    while ((result = front(payload, payload_size)) == networking::framer::status::COMPLETE)
+    {
+        pop();
+        if (on_frame) { on_frame(payload, payload_size); }
+    }
+
+    return (result != networking::framer::status::MALFORMED);
+}
+
+
+networking::framer::status networking::framer::front(unsigned char*& payload, std::size_t& size)
+{
+    if (!is_front_)
+    {
+        if (begin_ == end_) {
+            return networking::framer::status::INCOMPLETE;
+        }
+
+        const networking::framer::status result = next_frame(buffer_.data() + begin_, end_ - begin_, front_);
+        if (result == networking::framer::status::MALFORMED || 
+            (result == networking::framer::status::INCOMPLETE && end_ - begin_ > max_frame_size_ + 2 * MAX_ENVELOPE_SIZE))
+        {
+            reset();
+            return networking::framer::status::MALFORMED;
+        }
+        else if (result == networking::framer::status::INCOMPLETE) {
+            return result;
+        }
+
+        is_front_ = true;
+    }
+
+    payload = buffer_.data() + begin_ + front_.offset_;
+    size = front_.size_;
+    return networking::framer::status::COMPLETE;
+}
+
+
+// Unlike front() this neither remembers the frame nor drops a malformed buffer, so it can
+// answer a readiness check without disturbing the reader.
+bool networking::framer::has_complete_frame() const
+{
+    if (is_front_) {
+        return true;
+    }
+    else if (begin_ == end_) {
+        return false;
+    }
+
+    networking::framer::bounds frame = front_;
+    return (next_frame(buffer_.data() + begin_, end_ - begin_, frame) == networking::framer::status::COMPLETE);
+}
+
+
+// The payload handed out by front() stays valid until the next prepare(), so it can still be
+// read after pop().
+void networking::framer::pop()
+{
+    if (is_front_)
+    {
+        begin_ += front_.length_;
+        is_front_ = false;
+
+        if (begin_ == end_) {
+            begin_ = end_ = 0;
+        }
+    }
+}
+
+
+bool networking::framer::feed(const void* const data, const std::size_t& size, const networking::framer::frame_callback& on_frame)
+{
+    std::memcpy(prepare(size), data, size);
+    return commit(size, on_frame);
+}
+
+
+
+networking::length_prefix_framer::length_prefix_framer(const std::size_t& max_frame_size) :
+    networking::framer(max_frame_size)
+{
+
+}
+
+
+std::unique_ptr<networking::framer> networking::length_prefix_framer::clone() const
+{
+    return std::unique_ptr<networking::framer>(new networking::length_prefix_framer(max_frame_size()));
+}
+
+
+bool networking::length_prefix_framer::wrap(const std::size_t& size, networking::framer::envelope& frame) const
+{
+    frame.header_size_ = networking::frame_header::encode(size, frame.header_);
+    frame.trailer_size_ = 0;
+    return true;
+}
+
+
+bool networking::length_prefix_framer::wrap_compressed(const std::size_t& size, const std::uint8_t& codec, 
+    networking::framer::envelope& frame) const
+{
+    if (codec == 0 || codec >= networking::frame_header::CODECS_COUNT) { return false; }
+
+    frame.header_[0] = networking::frame_header::CODEC_PREFIX | codec;
+    frame.header_size_ = 1 + networking::frame_header::encode(size, frame.header_ + 1);
+    frame.trailer_size_ = 0;
+    return true;
+}
+
+
+bool networking::length_prefix_framer::is_payload_encoded() const
+{
+    return true;
+}
+
+
+networking::framer::status networking::length_prefix_framer::next_frame(const unsigned char* const data, const std::size_t& size,
+    networking::framer::bounds& frame) const
+{
+    const std::uint8_t codec = networking::frame_header::codec(data[0]);
+    const std::size_t prefix_size = (codec != 0) ? 1 : 0;
+    if (size <= prefix_size) { return networking::framer::status::INCOMPLETE; }
+
+    const std::size_t header_size = networking::frame_header::size(data[prefix_size]);
+    if (header_size == 0) { return networking::framer::status::MALFORMED; }
+    else if (size < prefix_size + header_size) { return networking::framer::status::INCOMPLETE; }
+
+    const std::uint64_t length = networking::frame_header::decode(data + prefix_size);
+    if (length > max_frame_size()) { return networking::framer::status::MALFORMED; }
+    else if (size - prefix_size - header_size < length) { return networking::framer::status::INCOMPLETE; }
+
+    frame.offset_ = prefix_size + header_size;
+    frame.size_ = static_cast<std::size_t>(length);
+    frame.length_ = frame.offset_ + frame.size_;
+    frame.codec_ = codec;
+    return networking::framer::status::COMPLETE;
+}
+
+
+
+networking::delimiter_framer::delimiter_framer(const std::string& delimiter, const std::size_t& max_frame_size) :
+    networking::framer(max_frame_size), delimiter_(delimiter)
+{
+    if (delimiter_.empty() || delimiter_.size() > MAX_ENVELOPE_SIZE) {
+        throw networking::networking_error("Frame delimiter must be 1 to 16 bytes long");
+    }
+}
+
+
+std::unique_ptr<networking::framer> networking::delimiter_framer::clone() const
+{
+    return std::unique_ptr<networking::framer>(new networking::delimiter_framer(delimiter_, max_frame_size()));
+}
+
+
+bool networking::delimiter_framer::wrap(const std::size_t& size, networking::framer::envelope& frame) const
+{
+    frame.header_size_ = 0;
+    frame.trailer_size_ = delimiter_.size();
+    std::memcpy(frame.trailer_, delimiter_.data(), delimiter_.size());
+    return true;
+}
+
+
+networking::framer::status networking::delimiter_framer::next_frame(const unsigned char* const data, const std::size_t& size,
+    networking::framer::bounds& frame) const
+{
+    const unsigned char* const found = std::search(data + std::min(frame.searched_, size), data + size, delimiter_.begin(), delimiter_.end(),
+        [](const unsigned char& a, const char& b) { return a == static_cast<unsigned char>(b); });
+
+    if (found == data + size)
+    {
+        // Only the tail that could still begin a delimiter has to be searched again.
+        frame.searched_ = (size >= delimiter_.size()) ? size - delimiter_.size() + 1 : 0;
+        return networking::framer::status::INCOMPLETE;
+    }
+
+    frame.searched_ = 0;
+    frame.offset_ = 0;
+    frame.size_ = static_cast<std::size_t>(found - data);
+    frame.length_ = frame.size_ + delimiter_.size();
+    return networking::framer::status::COMPLETE;
+}
+
+
+
+networking::fixed_size_framer::fixed_size_framer(const std::size_t& frame_size) :
+    networking::framer(frame_size), frame_size_(frame_size)
+{
+    if (frame_size_ == 0) {
+        throw networking::networking_error("Frame size must not be zero");
+    }
+}
+
+
+std::unique_ptr<networking::framer> networking::fixed_size_framer::clone() const
+{
+    return std::unique_ptr<networking::framer>(new networking::fixed_size_framer(frame_size_));
+}
+
+
+bool networking::fixed_size_framer::wrap(const std::size_t& size, networking::framer::envelope& frame) const
+{
+    frame.header_size_ = 0;
+    frame.trailer_size_ = 0;
+    return (size == frame_size_);
+}
+
+
+networking::framer::status networking::fixed_size_framer::next_frame(const unsigned char* const data, const std::size_t& size,
+    networking::framer::bounds& frame) const
+{
+    if (size < frame_size_) { return networking::framer::status::INCOMPLETE; }
+
+    frame.offset_ = 0;
+    frame.size_ = frame_size_;
+    frame.length_ = frame_size_;
+    return networking::framer::status::COMPLETE;
+}
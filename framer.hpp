@@ -0,0 +1,170 @@
+#ifndef __NETWORKING_FRAMER_HPP__
+#define __NETWORKING_FRAMER_HPP__
+#include <cinttypes>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace networking
+{
+    // Incremental parser that cuts a byte stream into frames, together with the envelope the
+    // sending side wraps around each payload. Bytes arrive through prepare()/commit() or feed()
+    // in chunks of any size; complete frames are handed to the callback in place and a partial
+    // frame stays buffered until the rest arrives. Readers that take one frame at a time use
+    // front()/pop() instead of a callback. One instance serves one connection.
+    class framer
+    {
+        public:
+            static constexpr std::size_t MAX_ENVELOPE_SIZE = 16;
+            static constexpr std::size_t DEFAULT_MAX_FRAME_SIZE = 64 * 1024 * 1024;
+
+            struct envelope
+            {
+                unsigned char header_[MAX_ENVELOPE_SIZE];
+                std::size_t header_size_ = 0;
+                unsigned char trailer_[MAX_ENVELOPE_SIZE];
+                std::size_t trailer_size_ = 0;
+            };
+
+            struct bounds
+            {
+                std::size_t offset_ = 0;
+                std::size_t size_ = 0;
+                std::size_t length_ = 0;
+                std::uint8_t codec_ = 0;
+                std::size_t searched_ = 0;
+            };
+
+            enum class status
+            {
+                COMPLETE, INCOMPLETE, MALFORMED
+            };
+
+            using frame_callback = std::function<void(unsigned char* const, const std::size_t&)>;
+
+        public:
+            framer(const std::size_t& max_frame_size = DEFAULT_MAX_FRAME_SIZE);
+            framer(const framer& obj) = delete;
+            framer(framer&& obj) = delete;
+            virtual ~framer() = default;
+
+            framer& operator=(const framer& obj) = delete;
+            framer& operator=(framer&& obj) = delete;
+
+            virtual std::unique_ptr<networking::framer> clone() const = 0;
+            virtual bool wrap(const std::size_t& size, networking::framer::envelope& frame) const = 0;
+            virtual bool wrap_compressed(const std::size_t& size, const std::uint8_t& codec, 
+                networking::framer::envelope& frame) const;
+            virtual bool is_payload_encoded() const;
+            virtual void reset();
+            unsigned char* prepare(const std::size_t& size);
+            void commit(const std::size_t& size);
+            bool commit(const std::size_t& size, const networking::framer::frame_callback& on_frame);
+            networking::framer::status front(unsigned char*& payload, std::size_t& size);
+            bool has_complete_frame() const;
+            void pop();
+            std::uint8_t front_codec() const;
+            bool feed(const void* const data, const std::size_t& size, const networking::framer::frame_callback& on_frame);
+            std::size_t buffered() const;
+            std::size_t max_frame_size() const;
+
+
+        protected:
+            // Looks for one frame at the start of data; offset_ and size_ locate the payload,
+            // length_ is the whole frame including its envelope and codec_ is non-zero when the
+            // payload is compressed. searched_ is left for the next call on the same frame, which
+            // then only looks at what arrived since.
+            virtual networking::framer::status next_frame(const unsigned char* const data, const std::size_t& size,
+                networking::framer::bounds& frame) const = 0;
+
+
+        private:
+            std::vector<unsigned char> buffer_;
+            std::size_t begin_ = 0;
+            std::size_t end_ = 0;
+            std::size_t max_frame_size_ = DEFAULT_MAX_FRAME_SIZE;
+            networking::framer::bounds front_;
+            bool is_front_ = false;
+    };
+
+
+    // The library's own wire format: a networking::frame_header length prefix followed by the
+    // payload in netbase byte order. Other framers carry the payload untouched, so they can
+    // speak foreign protocols.
+    class length_prefix_framer : public framer
+    {
+        public:
+            length_prefix_framer(const std::size_t& max_frame_size = DEFAULT_MAX_FRAME_SIZE);
+
+            std::unique_ptr<networking::framer> clone() const override;
+            bool wrap(const std::size_t& size, networking::framer::envelope& frame) const override;
+            bool wrap_compressed(const std::size_t& size, const std::uint8_t& codec, 
+                networking::framer::envelope& frame) const override;
+            bool is_payload_encoded() const override;
+
+
+        protected:
+            networking::framer::status next_frame(const unsigned char* const data, const std::size_t& size,
+                networking::framer::bounds& frame) const override;
+    };
+
+
+    class delimiter_framer : public framer
+    {
+        public:
+            delimiter_framer(const std::string& delimiter, const std::size_t& max_frame_size = DEFAULT_MAX_FRAME_SIZE);
+
+            std::unique_ptr<networking::framer> clone() const override;
+            bool wrap(const std::size_t& size, networking::framer::envelope& frame) const override;
+
+
+        protected:
+            networking::framer::status next_frame(const unsigned char* const data, const std::size_t& size,
+                networking::framer::bounds& frame) const override;
+
+
+        private:
+            std::string delimiter_;
+    };
+
+
+    class fixed_size_framer : public framer
+    {
+        public:
+            fixed_size_framer(const std::size_t& frame_size);
+
+            std::unique_ptr<networking::framer> clone() const override;
+            bool wrap(const std::size_t& size, networking::framer::envelope& frame) const override;
+
+
+        protected:
+            networking::framer::status next_frame(const unsigned char* const data, const std::size_t& size,
+                networking::framer::bounds& frame) const override;
+
+
+        private:
+            std::size_t frame_size_ = 0;
+    };
+}
+
+
+inline std::size_t networking::framer::buffered() const
+{
+    return end_ - begin_;
+}
+
+inline std::uint8_t networking::framer::front_codec() const
+{
+    return is_front_ ? front_.codec_ : 0;
+}
+
+inline std::size_t networking::framer::max_frame_size() const
+{
+    return max_frame_size_;
+}
+
+
+#endif
@@ -0,0 +1,286 @@
+#ifndef __NETWORKING_MESSAGE_HPP__
+#define __NETWORKING_MESSAGE_HPP__
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+
+
+namespace networking
+{
+    // Wire description of a message struct, declared inside the struct after its fields:
+    //   static constexpr auto layout = networking::make_layout(&quote::id, &quote::price);
+    // Fields are listed in declaration order and go on the wire packed and big-endian, so the
+    // encoding does not depend on the host's padding or byte order. A field is an arithmetic or
+    // enum type, or a one-dimensional array of them.
+    template<typename T, typename... F>
+    class message_layout
+    {
+        public:
+            using message_type = T;
+
+            template<std::size_t I>
+            using field_type = std::tuple_element_t<I, std::tuple<F...>>;
+
+            static constexpr std::size_t FIELDS_COUNT = sizeof...(F);
+            static constexpr std::size_t WIRE_SIZE = (sizeof(F) + ... + 0);
+
+            constexpr message_layout(F T::*... members) :
+                members_(members...)
+            {
+
+            }
+
+            template<std::size_t I>
+            constexpr field_type<I> T::* member() const
+            {
+                return std::get<I>(members_);
+            }
+
+            template<std::size_t I>
+            static constexpr std::size_t offset()
+            {
+                constexpr std::size_t sizes[] = { sizeof(F)..., 0 };
+                std::size_t result = 0;
+                for (std::size_t i = 0; i < I; ++i) { result += sizes[i]; }
+                return result;
+            }
+
+            // Size of T if it held exactly these fields in this order, with the usual alignment.
+            static constexpr std::size_t natural_size()
+            {
+                constexpr std::size_t sizes[] = { sizeof(F)..., 0 };
+                constexpr std::size_t alignments[] = { alignof(F)..., 1 };
+                std::size_t size = 0;
+                std::size_t alignment = 1;
+
+                for (std::size_t i = 0; i < FIELDS_COUNT; ++i)
+                {
+                    size = (size + alignments[i] - 1) / alignments[i] * alignments[i] + sizes[i];
+                    alignment = std::max(alignment, alignments[i]);
+                }
+
+                return (size + alignment - 1) / alignment * alignment;
+            }
+
+            static constexpr bool is_wire_type()
+            {
+                return ((std::rank_v<F> <= 1 && (std::is_arithmetic_v<std::remove_extent_t<F>> ||
+                    std::is_enum_v<std::remove_extent_t<F>>)) && ... && true);
+            }
+
+
+        private:
+            std::tuple<F T::*...> members_;
+    };
+
+
+    template<typename T, typename... F>
+    constexpr networking::message_layout<T, F...> make_layout(F T::*... members)
+    {
+        return networking::message_layout<T, F...>(members...);
+    }
+
+
+    // Encodes and decodes whole messages of a struct that declares a layout.
+    template<typename T>
+    class message
+    {
+        public:
+            using layout_type = std::decay_t<decltype(T::layout)>;
+
+            static constexpr std::size_t WIRE_SIZE = layout_type::WIRE_SIZE;
+
+            static_assert(std::is_same_v<typename layout_type::message_type, T>, "layout must describe the message struct itself");
+            static_assert(std::is_trivially_copyable_v<T>, "message struct must be trivially copyable");
+            static_assert(std::is_standard_layout_v<T>, "message struct must have a standard layout");
+            static_assert(layout_type::is_wire_type(), "message fields must be arithmetic, enum or arrays of them");
+            static_assert(layout_type::natural_size() == sizeof(T) && layout_type::WIRE_SIZE <= sizeof(T),
+                "layout must list every field of the message struct in declaration order");
+
+            message() = delete;
+
+            static void encode(const T& obj, unsigned char* const buffer)
+            {
+                encode_fields(obj, buffer, std::make_index_sequence<layout_type::FIELDS_COUNT>());
+            }
+
+            static T decode(const unsigned char* const buffer)
+            {
+                T obj;
+                decode_fields(obj, buffer, std::make_index_sequence<layout_type::FIELDS_COUNT>());
+                return obj;
+            }
+
+            template<std::size_t I>
+            using element_type = std::remove_extent_t<typename layout_type::template field_type<I>>;
+
+            template<std::size_t I>
+            static constexpr std::size_t ELEMENTS_COUNT = sizeof(typename layout_type::template field_type<I>) / sizeof(element_type<I>);
+
+            // Position of a member in the layout, so fields can be named instead of counted.
+            template<auto Member, std::size_t I = 0>
+            static constexpr std::size_t index_of()
+            {
+                static_assert(I < layout_type::FIELDS_COUNT, "member is not part of the message layout");
+
+                constexpr bool is_found = [] {
+                    if constexpr (std::is_same_v<decltype(Member), typename layout_type::template field_type<I> T::*>) {
+                        return (T::layout.template member<I>() == Member);
+                    }
+                    else { return false; }
+                }();
+
+                if constexpr (is_found) { return I; }
+                else { return index_of<Member, I + 1>(); }
+            }
+
+            template<std::size_t I>
+            static void store(const element_type<I>* const elements, unsigned char* const buffer)
+            {
+                for (std::size_t i = 0; i < ELEMENTS_COUNT<I>; ++i) {
+                    store_element(elements[i], buffer + layout_type::template offset<I>() + i * sizeof(element_type<I>));
+                }
+            }
+
+            template<std::size_t I>
+            static void load(element_type<I>* const elements, const unsigned char* const buffer)
+            {
+                for (std::size_t i = 0; i < ELEMENTS_COUNT<I>; ++i) {
+                    elements[i] = load_element<element_type<I>>(buffer + layout_type::template offset<I>() + i * sizeof(element_type<I>));
+                }
+            }
+
+
+        private:
+            template<std::size_t... I>
+            static void encode_fields(const T& obj, unsigned char* const buffer, std::index_sequence<I...>)
+            {
+                (store<I>(elements_of(obj.*(T::layout.template member<I>())), buffer), ...);
+            }
+
+            template<std::size_t... I>
+            static void decode_fields(T& obj, const unsigned char* const buffer, std::index_sequence<I...>)
+            {
+                (load<I>(elements_of(obj.*(T::layout.template member<I>())), buffer), ...);
+            }
+
+            template<typename F>
+            static auto elements_of(F& field)
+            {
+                if constexpr (std::is_array_v<F>) { return &field[0]; }
+                else { return &field; }
+            }
+
+            template<typename E>
+            static void store_element(const E& element, unsigned char* const bytes)
+            {
+                if constexpr (std::is_same_v<E, bool>) { bytes[0] = element ? 1 : 0; }
+                else
+                {
+                    std::memcpy(bytes, &element, sizeof(E));
+                    to_big_endian(bytes, sizeof(E));
+                }
+            }
+
+            template<typename E>
+            static E load_element(const unsigned char* const bytes)
+            {
+                if constexpr (std::is_same_v<E, bool>) { return (bytes[0] != 0); }
+                else
+                {
+                    unsigned char value[sizeof(E)];
+                    std::memcpy(value, bytes, sizeof(E));
+                    to_big_endian(value, sizeof(E));
+
+                    E element;
+                    std::memcpy(&element, value, sizeof(E));
+                    return element;
+                }
+            }
+
+            // The conversion is its own inverse, so it also turns wire bytes back into host order.
+            static void to_big_endian(unsigned char* const bytes, const std::size_t& size)
+            {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+                std::reverse(bytes, bytes + size);
+#endif
+            }
+    };
+
+
+    // Typed read-only access to a received message that stays in the receive buffer: each
+    // field is converted from wire order when it is read, and nothing else is copied. The view
+    // is only valid as long as the buffer it points into.
+    template<typename T>
+    class message_view
+    {
+        public:
+            using layout_type = typename networking::message<T>::layout_type;
+
+            static constexpr std::size_t WIRE_SIZE = networking::message<T>::WIRE_SIZE;
+
+            message_view(const unsigned char* const data, const std::size_t& size) :
+                data_(data), size_(size)
+            {
+
+            }
+
+            bool is_valid() const
+            {
+                return (data_ != nullptr && size_ == WIRE_SIZE);
+            }
+
+            // Scalar fields come back by value, array fields as a std::array.
+            template<std::size_t I>
+            auto get() const
+            {
+                using element_t = typename networking::message<T>::template element_type<I>;
+
+                if constexpr (std::is_array_v<typename layout_type::template field_type<I>>)
+                {
+                    std::array<element_t, networking::message<T>::template ELEMENTS_COUNT<I>> field;
+                    networking::message<T>::template load<I>(field.data(), data_);
+                    return field;
+                }
+                else
+                {
+                    element_t field;
+                    networking::message<T>::template load<I>(&field, data_);
+                    return field;
+                }
+            }
+
+            template<auto Member>
+            auto field() const
+            {
+                return get<networking::message<T>::template index_of<Member>()>();
+            }
+
+            T read() const
+            {
+                return networking::message<T>::decode(data_);
+            }
+
+            const unsigned char* data() const
+            {
+                return data_;
+            }
+
+            std::size_t size() const
+            {
+                return size_;
+            }
+
+
+        private:
+            const unsigned char* data_ = nullptr;
+            std::size_t size_ = 0;
+    };
+}
+
+
+#endif
@@ -0,0 +1,300 @@
+#include "metrics.hpp"
+#include "netbase.hpp"
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+
+static_assert(networking::metrics_snapshot::ERRORS_COUNT == static_cast<std::size_t>(networking::error::LOG_FILE_ERROR) + 1, 
+    "metrics_snapshot::ERRORS_COUNT must cover every networking::error");
+
+
+networking::histogram::histogram()
+{
+    reset();
+}
+
+
+void networking::histogram::reset()
+{
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    min_.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+    for (auto& b : buckets_) { b.store(0, std::memory_order_relaxed); }
+}
+
+
+void networking::histogram::record(const std::uint64_t& value)
+{
+    buckets_[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+
+    std::uint64_t current = min_.load(std::memory_order_relaxed);
+    while (value < current && !min_.compare_exchange_weak(current, value, std::memory_order_relaxed));
+
+    current = max_.load(std::memory_order_relaxed);
+    while (value > current && !max_.compare_exchange_weak(current, value, std::memory_order_relaxed));
+}
+
+
+void networking::histogram::merge_into(networking::histogram::snapshot& s) const
+{
+    networking::histogram::snapshot own;
+    own.count_ = count_.load(std::memory_order_relaxed);
+    if (own.count_ == 0) { return; }
+
+    own.sum_ = sum_.load(std::memory_order_relaxed);
+    own.min_ = min_.load(std::memory_order_relaxed);
+    own.max_ = max_.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < BUCKETS_COUNT; ++i) {
+        own.buckets_[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+
+    s.merge(own);
+}
+
+
+std::size_t networking::histogram::bucket_index(const std::uint64_t& value)
+{
+    if (value < SUB_BUCKETS) { return value; }
+
+    const std::size_t msb = 63 - __builtin_clzll(value);
+    const std::size_t shift = msb - 3;
+    return (shift + 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+}
+
+
+std::uint64_t networking::histogram::bucket_value(const std::size_t& index)
+{
+    if (index < SUB_BUCKETS) { return index; }
+
+    const std::size_t shift = index / SUB_BUCKETS - 1;
+    const std::uint64_t sub = index % SUB_BUCKETS;
+    return ((SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+
+
+void networking::histogram::snapshot::merge(const networking::histogram::snapshot& obj)
+{
+    if (obj.count_ == 0) { return; }
+
+    if (count_ == 0)
+    {
+        min_ = obj.min_;
+        max_ = obj.max_;
+    }
+    else
+    {
+        min_ = std::min(min_, obj.min_);
+        max_ = std::max(max_, obj.max_);
+    }
+
+    count_ += obj.count_;
+    sum_ += obj.sum_;
+    for (std::size_t i = 0; i < BUCKETS_COUNT; ++i) { buckets_[i] += obj.buckets_[i]; }
+}
+
+
+std::uint64_t networking::histogram::snapshot::percentile(const double& p) const
+{
+    if (count_ == 0) { return 0; }
+
+    const std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(p / 100.0 * count_ + 0.5));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < BUCKETS_COUNT; ++i)
+    {
+        seen += buckets_[i];
+        if (seen >= rank) { return std::min(std::max(histogram::bucket_value(i), min_), max_); }
+    }
+
+    return max_;
+}
+
+
+double networking::histogram::snapshot::mean() const
+{
+    if (count_ == 0) { return 0.0; }
+    return static_cast<double>(sum_) / count_;
+}
+
+
+
+std::uint64_t networking::metrics_snapshot::errors_count() const
+{
+    std::uint64_t count = 0;
+    for (std::size_t i = 1; i < ERRORS_COUNT; ++i) { count += errors_[i]; }
+    return count;
+}
+
+
+std::uint64_t networking::metrics_snapshot::error_count(const networking::error& error_type) const
+{
+    const std::size_t index = static_cast<std::size_t>(error_type);
+    if (index < ERRORS_COUNT) { return errors_[index]; }
+    return 0;
+}
+
+
+
+networking::connection_metrics::connection_metrics()
+{
+    reset();
+}
+
+
+void networking::connection_metrics::reset()
+{
+    bytes_transmitted_.store(0, std::memory_order_relaxed);
+    bytes_received_.store(0, std::memory_order_relaxed);
+    messages_transmitted_.store(0, std::memory_order_relaxed);
+    messages_received_.store(0, std::memory_order_relaxed);
+    accepts_.store(0, std::memory_order_relaxed);
+    disconnects_.store(0, std::memory_order_relaxed);
+    last_activity_.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    for (auto& e : errors_) { e.store(0, std::memory_order_relaxed); }
+}
+
+
+void networking::connection_metrics::record_transfer(const std::uint64_t& bytes)
+{
+    bytes_transmitted_.fetch_add(bytes, std::memory_order_relaxed);
+    messages_transmitted_.fetch_add(1, std::memory_order_relaxed);
+    last_activity_.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+
+void networking::connection_metrics::record_receive(const std::uint64_t& bytes)
+{
+    bytes_received_.fetch_add(bytes, std::memory_order_relaxed);
+    messages_received_.fetch_add(1, std::memory_order_relaxed);
+    last_activity_.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+
+void networking::connection_metrics::record_error(const networking::error& error_type)
+{
+    const std::size_t index = static_cast<std::size_t>(error_type);
+    if (index < errors_.size()) { errors_[index].fetch_add(1, std::memory_order_relaxed); }
+}
+
+
+void networking::connection_metrics::record_accept()
+{
+    accepts_.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+void networking::connection_metrics::record_disconnect()
+{
+    disconnects_.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+std::chrono::steady_clock::time_point networking::connection_metrics::last_activity() const
+{
+    return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(last_activity_.load(std::memory_order_relaxed)));
+}
+
+
+void networking::connection_metrics::merge_into(networking::metrics_snapshot& s) const
+{
+    s.bytes_transmitted_ += bytes_transmitted_.load(std::memory_order_relaxed);
+    s.bytes_received_ += bytes_received_.load(std::memory_order_relaxed);
+    s.messages_transmitted_ += messages_transmitted_.load(std::memory_order_relaxed);
+    s.messages_received_ += messages_received_.load(std::memory_order_relaxed);
+    s.accepts_ += accepts_.load(std::memory_order_relaxed);
+    s.disconnects_ += disconnects_.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < errors_.size(); ++i) {
+        s.errors_[i] += errors_[i].load(std::memory_order_relaxed);
+    }
+}
+
+
+networking::metrics_snapshot networking::connection_metrics::snapshot() const
+{
+    networking::metrics_snapshot s;
+    merge_into(s);
+    return s;
+}
+
+
+
+networking::endpoint_metrics::endpoint_metrics() :
+    stripes_(new stripe[STRIPES_COUNT])
+{
+
+}
+
+
+void networking::endpoint_metrics::reset()
+{
+    for (std::size_t i = 0; i < STRIPES_COUNT; ++i)
+    {
+        stripes_[i].counters_.reset();
+        stripes_[i].transfer_latency_.reset();
+        stripes_[i].receive_latency_.reset();
+        stripes_[i].message_size_.reset();
+    }
+}
+
+
+void networking::endpoint_metrics::record_transfer(const std::uint64_t& bytes, const std::uint64_t& latency_ns)
+{
+    stripe& s = local_stripe();
+    s.counters_.record_transfer(bytes);
+    s.transfer_latency_.record(latency_ns);
+    s.message_size_.record(bytes);
+}
+
+
+void networking::endpoint_metrics::record_receive(const std::uint64_t& bytes, const std::uint64_t& latency_ns)
+{
+    stripe& s = local_stripe();
+    s.counters_.record_receive(bytes);
+    s.receive_latency_.record(latency_ns);
+    s.message_size_.record(bytes);
+}
+
+
+void networking::endpoint_metrics::record_error(const networking::error& error_type)
+{
+    local_stripe().counters_.record_error(error_type);
+}
+
+
+void networking::endpoint_metrics::record_accept()
+{
+    local_stripe().counters_.record_accept();
+}
+
+
+void networking::endpoint_metrics::record_disconnect()
+{
+    local_stripe().counters_.record_disconnect();
+}
+
+
+networking::metrics_snapshot networking::endpoint_metrics::snapshot() const
+{
+    networking::metrics_snapshot s;
+    for (std::size_t i = 0; i < STRIPES_COUNT; ++i)
+    {
+        stripes_[i].counters_.merge_into(s);
+        stripes_[i].transfer_latency_.merge_into(s.transfer_latency_);
+        stripes_[i].receive_latency_.merge_into(s.receive_latency_);
+        stripes_[i].message_size_.merge_into(s.message_size_);
+    }
+
+    return s;
+}
+
+
+networking::endpoint_metrics::stripe& networking::endpoint_metrics::local_stripe()
+{
+    static std::atomic<std::size_t> next_stripe(0);
+    thread_local const std::size_t index = next_stripe.fetch_add(1, std::memory_order_relaxed) % STRIPES_COUNT;
+    return stripes_[index];
+}
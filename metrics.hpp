@@ -0,0 +1,157 @@
+#ifndef __NETWORKING_METRICS_HPP__
+#define __NETWORKING_METRICS_HPP__
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <memory>
+
+
+namespace networking
+{
+    enum class error;
+
+    class histogram
+    {
+        public:
+            static constexpr std::size_t SUB_BUCKETS = 8;
+            static constexpr std::size_t BUCKETS_COUNT = 62 * SUB_BUCKETS;
+
+            struct snapshot
+            {
+                public:
+                    void merge(const snapshot& obj);
+                    std::uint64_t percentile(const double& p) const;
+                    double mean() const;
+
+                    std::uint64_t count_ = 0;
+                    std::uint64_t sum_ = 0;
+                    std::uint64_t min_ = 0;
+                    std::uint64_t max_ = 0;
+                    std::array<std::uint64_t, BUCKETS_COUNT> buckets_ = {};
+            };
+
+        public:
+            histogram();
+            histogram(const histogram& obj) = delete;
+            histogram(histogram&& obj) = delete;
+            ~histogram() = default;
+
+            histogram& operator=(const histogram& obj) = delete;
+            histogram& operator=(histogram&& obj) = delete;
+
+            void reset();
+            void record(const std::uint64_t& value);
+            void merge_into(snapshot& s) const;
+
+            static std::size_t bucket_index(const std::uint64_t& value);
+            static std::uint64_t bucket_value(const std::size_t& index);
+
+
+        private:
+            std::atomic<std::uint64_t> count_;
+            std::atomic<std::uint64_t> sum_;
+            std::atomic<std::uint64_t> min_;
+            std::atomic<std::uint64_t> max_;
+            std::array<std::atomic<std::uint64_t>, BUCKETS_COUNT> buckets_;
+    };
+
+
+    struct metrics_snapshot
+    {
+        public:
+            static constexpr std::size_t ERRORS_COUNT = 13;
+
+            std::uint64_t errors_count() const;
+            std::uint64_t error_count(const networking::error& error_type) const;
+
+            std::uint64_t bytes_transmitted_ = 0;
+            std::uint64_t bytes_received_ = 0;
+            std::uint64_t messages_transmitted_ = 0;
+            std::uint64_t messages_received_ = 0;
+            std::uint64_t accepts_ = 0;
+            std::uint64_t disconnects_ = 0;
+            std::array<std::uint64_t, ERRORS_COUNT> errors_ = {};
+            networking::histogram::snapshot transfer_latency_;
+            networking::histogram::snapshot receive_latency_;
+            networking::histogram::snapshot message_size_;
+    };
+
+
+    class connection_metrics
+    {
+        public:
+            connection_metrics();
+            connection_metrics(const connection_metrics& obj) = delete;
+            connection_metrics(connection_metrics&& obj) = delete;
+            ~connection_metrics() = default;
+
+            connection_metrics& operator=(const connection_metrics& obj) = delete;
+            connection_metrics& operator=(connection_metrics&& obj) = delete;
+
+            void reset();
+            void record_transfer(const std::uint64_t& bytes);
+            void record_receive(const std::uint64_t& bytes);
+            void record_error(const networking::error& error_type);
+            void record_accept();
+            void record_disconnect();
+            std::chrono::steady_clock::time_point last_activity() const;
+            void merge_into(networking::metrics_snapshot& s) const;
+            networking::metrics_snapshot snapshot() const;
+
+
+        private:
+            std::atomic<std::uint64_t> bytes_transmitted_;
+            std::atomic<std::uint64_t> bytes_received_;
+            std::atomic<std::uint64_t> messages_transmitted_;
+            std::atomic<std::uint64_t> messages_received_;
+            std::atomic<std::uint64_t> accepts_;
+            std::atomic<std::uint64_t> disconnects_;
+            std::atomic<std::chrono::steady_clock::rep> last_activity_;
+            std::array<std::atomic<std::uint64_t>, networking::metrics_snapshot::ERRORS_COUNT> errors_;
+    };
+
+
+    class endpoint_metrics
+    {
+        public:
+            static constexpr std::size_t STRIPES_COUNT = 8;
+
+        public:
+            endpoint_metrics();
+            endpoint_metrics(const endpoint_metrics& obj) = delete;
+            endpoint_metrics(endpoint_metrics&& obj) = delete;
+            ~endpoint_metrics() = default;
+
+            endpoint_metrics& operator=(const endpoint_metrics& obj) = delete;
+            endpoint_metrics& operator=(endpoint_metrics&& obj) = delete;
+
+            void reset();
+            void record_transfer(const std::uint64_t& bytes, const std::uint64_t& latency_ns);
+            void record_receive(const std::uint64_t& bytes, const std::uint64_t& latency_ns);
+            void record_error(const networking::error& error_type);
+            void record_accept();
+            void record_disconnect();
+            networking::metrics_snapshot snapshot() const;
+
+
+        private:
+            // Each thread updates its own cache-line aligned stripe, so the hot path does not
+            // bounce counters between cores; stripes are only summed when a snapshot is taken.
+            struct alignas(64) stripe
+            {
+                networking::connection_metrics counters_;
+                networking::histogram transfer_latency_;
+                networking::histogram receive_latency_;
+                networking::histogram message_size_;
+            };
+
+            stripe& local_stripe();
+
+            std::unique_ptr<stripe[]> stripes_;
+    };
+}
+
+
+#endif
@@ -8,6 +8,8 @@
 #include <stdexcept>
 #include <unistd.h>
 #include <sys/socket.h>
+#include <netinet/tcp.h>
+#include <poll.h>
 #include <mutex>
 
 
@@ -17,8 +19,9 @@ networking::netbase::~netbase()
 }
 
 
-networking::netbase::netbase(const std::string& ip_address, const std::uint16_t& port, const networking::communication& communication_type, const std::string& log_file_path) :
-    communication_type_(communication_type), log_file_path_(log_file_path), last_error_(networking::error::NONE)
+networking::netbase::netbase(const std::string& ip_address, const std::uint16_t& port, const networking::communication& communication_type, 
+    const std::string& log_file_path, const networking::socket_options& options) :
+    communication_type_(communication_type), log_file_path_(log_file_path), last_error_(networking::error::NONE), options_(options)
 {
     if (communication_type_ == networking::communication::LOCAL) { server_.connection_.sin_family = AF_UNIX; }
     else { server_.connection_.sin_family = AF_INET; }
@@ -34,16 +37,20 @@ void networking::netbase::reset()
     log_file_path_.clear();
     communication_type_ = networking::communication::NONE;
     last_error_ = networking::error::NONE;
+    options_ = networking::socket_options();
+    metrics_.reset();
 }
 
 
 void networking::netbase::reload(const std::string& ip_address, const std::uint16_t& port, 
-                const networking::communication& communication_type, const std::string& log_file_path)
+                const networking::communication& communication_type, const std::string& log_file_path, 
+                const networking::socket_options& options)
 {
     end();
     
     communication_type_ = communication_type;
     log_file_path_ = log_file_path;
+    options_ = options;
     last_error_ = networking::error::NONE;
 
     if (communication_type_ == networking::communication::LOCAL) { server_.connection_.sin_family = AF_UNIX; }
@@ -58,9 +65,9 @@ void networking::netbase::reload(const std::string& ip_address, const std::uint1
 
 void networking::netbase::end()
 {
-    if (is_running())
+    lock_.lock();
+    if (server_.socket_ != networking::socket_t::NONE)
     {
-        lock_.lock();
         if (close(server_.socket_) == -1)
         {
             last_error_ = networking::error::CLOSE_SOCKET_ERROR;
@@ -70,8 +77,8 @@ void networking::netbase::end()
         }
         
         server_.socket_ = networking::socket_t::NONE;
-        lock_.unlock();
     }
+    lock_.unlock();
 }
 
 
@@ -109,6 +116,12 @@ const char* networking::netbase::get_error_message(const networking::error& erro
         case networking::error::RECEIVE_ERROR:
             message = "Failed to receive a data";
             break;
+        case networking::error::WAIT_ERROR:
+            message = "Failed to wait for the socket";
+            break;
+        case networking::error::TIMEOUT_ERROR:
+            message = "Operation timed out";
+            break;
         case networking::error::LOG_FILE_ERROR:
             message = "Failed to open the log file";
             break;
@@ -159,10 +172,11 @@ const char* networking::netbase::get_log_message(const networking::netbase::log&
 
 const char* networking::netbase::make_log(const networking::error& error_type, const std::string& append_message)
 {
-    const char* error_message = nullptr;
+    metrics_.record_error(error_type);
+
+    const char* error_message = get_error_message(error_type);
     if (!log_file_path_.empty())
     {
-        error_message = get_error_message(error_type);
         const time_t time_now = time(nullptr);
 
         std::unique_lock<std::shared_mutex> lock(lock_);
@@ -190,10 +204,9 @@ const char* networking::netbase::make_log(const networking::error& error_type, c
 
 const char* networking::netbase::make_log(const networking::netbase::log& log_type, const std::string& append_message)
 {
-    const char* log_message = nullptr;
+    const char* log_message = get_log_message(log_type);
     if (!log_file_path_.empty())
     {
-        log_message = get_log_message(log_type);
         const time_t time_now = time(nullptr);
 
         std::unique_lock<std::shared_mutex> lock(lock_);
@@ -219,6 +232,19 @@ const char* networking::netbase::make_log(const networking::netbase::log& log_ty
 }
 
 
+// Consumes a message that is not a whole number of elements, so it is neither truncated nor
+// copied past the end of a buffer sized in elements, and the next receive starts cleanly.
+void networking::netbase::reject_message(const networking::socket_t& sock, const std::size_t& size, const std::size_t& element_size)
+{
+    std::vector<unsigned char> discarded(size);
+    receive(sock, discarded.data(), size);
+
+    last_error_ = networking::error::RECEIVE_ERROR;
+    make_log(last_error_, "message of " + std::to_string(size) + " B is not a whole number of " + 
+        std::to_string(element_size) + " B elements");
+}
+
+
 void networking::netbase::reverse_byte_order(unsigned char* const data, const std::size_t& size)
 {
     if (data != nullptr && size > 0)
@@ -243,6 +269,81 @@ unsigned char networking::netbase::reverse_bit_order(unsigned char b)
 }
 
 
+bool networking::netbase::wait_readable(const networking::socket_t& sock, const std::chrono::milliseconds& timeout)
+{
+    return (is_frame_buffered(sock) || wait_for(sock, POLLIN | POLLRDHUP, timeout));
+}
+
+
+bool networking::netbase::wait_writable(const networking::socket_t& sock, const std::chrono::milliseconds& timeout)
+{
+    return wait_for(sock, POLLOUT, timeout);
+}
+
+
+std::vector<networking::socket_t> networking::netbase::wait_any(const std::vector<networking::socket_t>& socks, 
+    const std::chrono::milliseconds& timeout)
+{
+    std::vector<networking::socket_t> ready;
+    std::vector<pollfd> fds;
+    fds.reserve(socks.size());
+
+    for (const auto& sock : socks) 
+    {
+        if (sock != networking::socket_t::NONE) 
+        {
+            if (is_frame_buffered(sock)) { ready.push_back(sock); }
+            else { fds.push_back(pollfd{sock, POLLIN | POLLRDHUP, 0}); }
+        }
+    }
+
+    if (fds.empty()) { return ready; }
+
+    // Frames already buffered in user space are ready now, so the poll must not block.
+    const int wait_ms = !ready.empty() ? 0 : (timeout.count() < 0 ? -1 : static_cast<int>(timeout.count()));
+    const int result = poll(fds.data(), fds.size(), wait_ms);
+    if (result < 0)
+    {
+        if (errno == EINTR) { return ready; }
+
+        last_error_ = networking::error::WAIT_ERROR;
+        const char* message = make_log(last_error_, strerror(errno));
+        throw networking::networking_error(message);
+    }
+
+    for (const auto& fd : fds) {
+        if (fd.revents != 0) { ready.push_back(fd.fd); }
+    }
+
+    return ready;
+}
+
+
+bool networking::netbase::is_frame_buffered(const networking::socket_t& sock) const
+{
+    return false;
+}
+
+
+bool networking::netbase::wait_for(const networking::socket_t& sock, const short& events, const std::chrono::milliseconds& timeout)
+{
+    if (sock == networking::socket_t::NONE) { return false; }
+
+    pollfd fd = {sock, events, 0};
+    const int result = poll(&fd, 1, timeout.count() < 0 ? -1 : static_cast<int>(timeout.count()));
+    if (result < 0)
+    {
+        if (errno == EINTR) { return false; }
+
+        last_error_ = networking::error::WAIT_ERROR;
+        const char* message = make_log(last_error_, strerror(errno));
+        throw networking::networking_error(message);
+    }
+
+    return (result > 0);
+}
+
+
 bool networking::netbase::is_big_endian()
 {
     int n = 1;
@@ -294,4 +395,83 @@ std::string networking::netbase::connection::info() const
     std::stringstream s_info;
     s_info << "IP address: " << inet_ntoa(connection_.sin_addr) << "   Port: " << ntohs(connection_.sin_port) << "   Socket: " << socket_;
     return s_info.str();
-}
\ No newline at end of file
+}
+
+
+bool networking::netbase::apply_options(const networking::socket_t& sock, const int& type) const
+{
+    auto set = [&sock](const int& level, const int& name, const int& value) {
+        return (setsockopt(sock, level, name, &value, sizeof(value)) != -1);
+    };
+
+    const bool is_tcp = (type == SOCK_STREAM && communication_type_ != networking::communication::LOCAL);
+    const bool is_udp = (type == SOCK_DGRAM && communication_type_ != networking::communication::LOCAL);
+
+    in_addr interface = {0};
+    if (is_udp && options_.multicast_interface_ && inet_aton(options_.multicast_interface_->data(), &interface) == 0)
+    {
+        errno = EINVAL;
+        return false;
+    }
+
+    return (!options_.send_buffer_ || set(SOL_SOCKET, SO_SNDBUF, *options_.send_buffer_)) && 
+        (!options_.receive_buffer_ || set(SOL_SOCKET, SO_RCVBUF, *options_.receive_buffer_)) && 
+        (!options_.busy_poll_ || set(SOL_SOCKET, SO_BUSY_POLL, *options_.busy_poll_)) && 
+        (!is_tcp || !options_.no_delay_ || set(IPPROTO_TCP, TCP_NODELAY, *options_.no_delay_)) && 
+        (!is_tcp || !options_.cork_ || set(IPPROTO_TCP, TCP_CORK, *options_.cork_)) && 
+        (!is_tcp || !options_.quick_ack_ || set(IPPROTO_TCP, TCP_QUICKACK, *options_.quick_ack_)) && 
+        (!is_udp || !options_.multicast_ttl_ || set(IPPROTO_IP, IP_MULTICAST_TTL, *options_.multicast_ttl_)) && 
+        (!is_udp || !options_.multicast_loop_ || set(IPPROTO_IP, IP_MULTICAST_LOOP, *options_.multicast_loop_)) && 
+        (!is_udp || !options_.multicast_interface_ || 
+            setsockopt(sock, IPPROTO_IP, IP_MULTICAST_IF, &interface, sizeof(interface)) != -1);
+}
+
+
+networking::socket_options networking::netbase::applied_options(const networking::socket_t& sock) const
+{
+    networking::socket_options options;
+    auto get = [&sock](const int& level, const int& name) {
+        int value = 0;
+        socklen_t size = sizeof(value);
+        return (getsockopt(sock, level, name, &value, &size) == -1) ? std::optional<int>() : std::optional<int>(value);
+    };
+    auto get_flag = [&get](const int& level, const int& name) {
+        const std::optional<int> value = get(level, name);
+        return value ? std::optional<bool>(*value != 0) : std::optional<bool>();
+    };
+
+    if (sock != networking::socket_t::NONE)
+    {
+        options.send_buffer_ = get(SOL_SOCKET, SO_SNDBUF);
+        options.receive_buffer_ = get(SOL_SOCKET, SO_RCVBUF);
+        options.busy_poll_ = get(SOL_SOCKET, SO_BUSY_POLL);
+
+        if (get(SOL_SOCKET, SO_TYPE) == SOCK_STREAM && communication_type_ != networking::communication::LOCAL)
+        {
+            options.no_delay_ = get_flag(IPPROTO_TCP, TCP_NODELAY);
+            options.cork_ = get_flag(IPPROTO_TCP, TCP_CORK);
+            options.quick_ack_ = get_flag(IPPROTO_TCP, TCP_QUICKACK);
+        }
+        else if (get(SOL_SOCKET, SO_TYPE) == SOCK_DGRAM && communication_type_ != networking::communication::LOCAL)
+        {
+            options.multicast_ttl_ = get(IPPROTO_IP, IP_MULTICAST_TTL);
+            options.multicast_loop_ = get_flag(IPPROTO_IP, IP_MULTICAST_LOOP);
+
+            in_addr interface = {0};
+            socklen_t size = sizeof(interface);
+            if (getsockopt(sock, IPPROTO_IP, IP_MULTICAST_IF, &interface, &size) != -1) {
+                options.multicast_interface_ = address_string(interface);
+            }
+        }
+    }
+
+    return options;
+}
+
+
+// inet_ntoa() returns a buffer shared by every thread, so addresses are formatted into a local one.
+std::string networking::netbase::address_string(const in_addr& address)
+{
+    char buffer[INET_ADDRSTRLEN] = {0};
+    return (inet_ntop(AF_INET, &address, buffer, sizeof(buffer)) != nullptr) ? buffer : "";
+}
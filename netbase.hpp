@@ -1,12 +1,15 @@
 #ifndef __NETWORKING_NETBASE_HPP__
 #define __NETWORKING_NETBASE_HPP__
 #include "socket.hpp"
+#include "metrics.hpp"
+#include "socket_options.hpp"
 #include <string>
 #include <cinttypes>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <shared_mutex>
 #include <vector>
+#include <chrono>
 
 
 namespace networking
@@ -15,7 +18,7 @@ namespace networking
     {
         NONE, OPEN_SOCKET_ERROR, CLOSE_SOCKET_ERROR, SET_SOCKET_OPTIONS_ERROR, 
         BIND_TO_SOCKET_ERROR, LISTEN_ON_SOCKET_ERROR, ACCEPT_CONNECTION_ERROR, 
-        CONNECT_ERROR, TRANSFER_ERROR, RECEIVE_ERROR, LOG_FILE_ERROR
+        CONNECT_ERROR, TRANSFER_ERROR, RECEIVE_ERROR, WAIT_ERROR, TIMEOUT_ERROR, LOG_FILE_ERROR
     };
 
     enum class communication
@@ -28,26 +31,43 @@ namespace networking
         public:
             netbase() = default;
             netbase(const std::string& ip_address, const std::uint16_t& port, 
-                const networking::communication& communicaton_type, const std::string& log_file_path = "");
+                const networking::communication& communicaton_type, const std::string& log_file_path = "", 
+                const networking::socket_options& options = networking::socket_options());
             netbase(const netbase& obj) = delete;
             netbase(const netbase&& obj) = delete;
             virtual ~netbase() = 0;
 
             virtual void reset();
             virtual void reload(const std::string& ip_address, const std::uint16_t& port, 
-                const networking::communication& communicaton_type, const std::string& log_file_path = "");
+                const networking::communication& communicaton_type, const std::string& log_file_path = "", 
+                const networking::socket_options& options = networking::socket_options());
             virtual void start() = 0;
             virtual void end();
             virtual bool is_running() const = 0;
             virtual bool is_data_to_receive(const networking::socket_t& sock) const = 0;
+            bool wait_readable(const networking::socket_t& sock, 
+                const std::chrono::milliseconds& timeout = std::chrono::milliseconds(-1));
+            bool wait_writable(const networking::socket_t& sock, 
+                const std::chrono::milliseconds& timeout = std::chrono::milliseconds(-1));
+            std::vector<networking::socket_t> wait_any(const std::vector<networking::socket_t>& socks, 
+                const std::chrono::milliseconds& timeout = std::chrono::milliseconds(-1));
 
             networking::error last_error() const;
+            networking::metrics_snapshot metrics() const;
+            void reset_metrics();
             std::string ip_address() const;
             std::uint16_t port() const;
             networking::communication communicaton_type() const;
             std::string log_file_path() const;
+            networking::socket_options options() const;
+            void options(const networking::socket_options& options);
+            std::chrono::milliseconds operation_timeout() const;
+            void operation_timeout(const std::chrono::milliseconds& timeout);
+            networking::socket_options applied_options() const;
+            networking::socket_options applied_options(const networking::socket_t& sock) const;
 
             static bool is_big_endian();
+            static std::string address_string(const in_addr& address);
 
 
         protected:
@@ -83,7 +103,12 @@ namespace networking
             virtual bool receive(const networking::socket_t& sock, void* const data, const std::size_t& size) = 0;
             virtual bool transfer(const networking::socket_t& sock, void* const data, const std::size_t& size) = 0;
             virtual void receive_byte_count(const networking::socket_t& sock, std::size_t& count) = 0;
+            virtual bool is_frame_buffered(const networking::socket_t& sock) const;
+            void reject_message(const networking::socket_t& sock, const std::size_t& size, const std::size_t& element_size);
             void reverse_byte_order(unsigned char* const data, const std::size_t& size);
+            bool apply_options(const networking::socket_t& sock, const int& type) const;
+            bool wait_for(const networking::socket_t& sock, const short& events, const std::chrono::milliseconds& timeout);
+            static std::uint64_t elapsed_ns(const std::chrono::steady_clock::time_point& start);
 
 
         private:
@@ -97,6 +122,9 @@ namespace networking
             networking::communication communication_type_ = networking::communication::NONE;
             std::string log_file_path_;
             networking::error last_error_ = networking::error::NONE;
+            networking::socket_options options_;
+            std::chrono::milliseconds operation_timeout_ = std::chrono::milliseconds(0);
+            networking::endpoint_metrics metrics_;
             mutable std::shared_mutex lock_;
     };
 }
@@ -107,6 +135,21 @@ inline networking::error networking::netbase::last_error() const
     return last_error_;
 }
 
+inline networking::metrics_snapshot networking::netbase::metrics() const
+{
+    return metrics_.snapshot();
+}
+
+inline void networking::netbase::reset_metrics()
+{
+    metrics_.reset();
+}
+
+inline std::uint64_t networking::netbase::elapsed_ns(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
 inline std::string networking::netbase::ip_address() const
 {
     return inet_ntoa(server_.connection_.sin_addr);
@@ -127,5 +170,30 @@ inline std::string networking::netbase::log_file_path() const
     return log_file_path_;
 }
 
+inline networking::socket_options networking::netbase::options() const
+{
+    return options_;
+}
+
+inline void networking::netbase::options(const networking::socket_options& options)
+{
+    options_ = options;
+}
+
+inline std::chrono::milliseconds networking::netbase::operation_timeout() const
+{
+    return operation_timeout_;
+}
+
+inline void networking::netbase::operation_timeout(const std::chrono::milliseconds& timeout)
+{
+    operation_timeout_ = timeout;
+}
+
+inline networking::socket_options networking::netbase::applied_options() const
+{
+    return applied_options(server_.socket_);
+}
+
 
 #endif
\ No newline at end of file
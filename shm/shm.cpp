@@ -0,0 +1,313 @@
+#include "shm.hpp"
+#include "networking_error.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+
+
+namespace
+{
+    // Blocking waits sleep in slices, so a wait that started just before end() still returns.
+    constexpr std::chrono::milliseconds WAIT_SLICE = std::chrono::milliseconds(100);
+}
+
+
+networking::shm::shm(const std::string& name, const std::string& log_file_path,
+    const std::size_t& slot_size, const std::size_t& slots_count) :
+    name_(name), slot_size_(slot_size), slots_count_(slots_count)
+{
+    log_file_path_ = log_file_path;
+}
+
+
+networking::shm::~shm()
+{
+    if (is_running())
+    {
+        try { end(); }
+        catch (...) {}
+    }
+}
+
+
+void networking::shm::start()
+{
+    if (!is_running())
+    {
+        std::unique_lock<std::mutex> lock(receive_lock_);
+        if (!inbound_.create(name_, slot_size_, slots_count_))
+        {
+            last_error_ = networking::error::OPEN_SOCKET_ERROR;
+            lock.unlock();
+            const char* message = make_log(last_error_, name_ + ": " + strerror(errno));
+            throw networking::networking_error(message);
+        }
+
+        is_running_.store(true, std::memory_order_release);
+        lock.unlock();
+
+        make_log(networking::netbase::log::ENDPOINT_READY_LOG, name_);
+    }
+}
+
+
+void networking::shm::reset()
+{
+    end();
+    unset_destination();
+    networking::netbase::reset();
+    name_.clear();
+    slot_size_ = DEFAULT_SLOT_SIZE;
+    slots_count_ = DEFAULT_SLOTS_COUNT;
+}
+
+
+void networking::shm::end()
+{
+    if (is_running_.exchange(false, std::memory_order_acq_rel))
+    {
+        inbound_.wake_all();
+        outbound_.wake_all();
+
+        std::unique_lock<std::mutex> lock(receive_lock_);
+        inbound_.close();
+        lock.unlock();
+
+        make_log(networking::netbase::log::ENDPOINT_CLOSED_LOG, name_);
+    }
+}
+
+
+void networking::shm::set_destination(const std::string& name)
+{
+    unset_destination();
+
+    std::unique_lock<std::shared_mutex> lock(destination_lock_);
+    if (!outbound_.open(name))
+    {
+        last_error_ = networking::error::CONNECT_ERROR;
+        lock.unlock();
+        const char* message = make_log(last_error_, name + ": " + strerror(errno));
+        throw networking::networking_error(message);
+    }
+
+    destination_name_ = name;
+    is_destination_.store(true, std::memory_order_release);
+}
+
+
+void networking::shm::unset_destination()
+{
+    is_destination_.store(false, std::memory_order_release);
+    outbound_.wake_all();
+
+    std::unique_lock<std::shared_mutex> lock(destination_lock_);
+    outbound_.close();
+    destination_name_.clear();
+}
+
+
+bool networking::shm::is_data_to_receive() const
+{
+    return shm::is_data_to_receive(server_.socket_);
+}
+
+
+bool networking::shm::wait_readable(const std::chrono::milliseconds& timeout)
+{
+    const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+    std::lock_guard<std::mutex> lock(receive_lock_);
+
+    while (is_running())
+    {
+        if (inbound_.wait_readable(slice(deadline, timeout.count() >= 0))) { return true; }
+        else if (timeout.count() >= 0 && std::chrono::steady_clock::now() >= deadline) { return false; }
+    }
+
+    return false;
+}
+
+
+bool networking::shm::wait_writable(const std::chrono::milliseconds& timeout)
+{
+    const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+    std::shared_lock<std::shared_mutex> lock(destination_lock_);
+
+    while (is_running() && is_destination())
+    {
+        if (outbound_.wait_writable(slice(deadline, timeout.count() >= 0))) { return true; }
+        else if (timeout.count() >= 0 && std::chrono::steady_clock::now() >= deadline) { return false; }
+    }
+
+    return false;
+}
+
+
+// Hands out every message already in the ring without copying it; each slot is released as
+// soon as its callback returns. The callback must not receive from this endpoint itself.
+std::size_t networking::shm::receive_frames(const networking::framer::frame_callback& on_frame)
+{
+    std::size_t frames = 0;
+    if (is_running())
+    {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(receive_lock_);
+
+        std::size_t size = 0;
+        const unsigned char* payload = nullptr;
+        while ((payload = inbound_.front(size)) != nullptr)
+        {
+            metrics_.record_receive(size, elapsed_ns(start));
+            if (on_frame) { on_frame(const_cast<unsigned char*>(payload), size); }
+            inbound_.pop();
+            frames += 1;
+        }
+    }
+
+    return frames;
+}
+
+
+bool networking::shm::is_destination() const
+{
+    return is_destination_.load(std::memory_order_acquire);
+}
+
+
+std::string networking::shm::destination_name() const
+{
+    std::shared_lock<std::shared_mutex> lock(destination_lock_);
+    return destination_name_;
+}
+
+
+bool networking::shm::is_data_to_receive(const networking::socket_t& sock) const
+{
+    std::size_t size = 0;
+    std::lock_guard<std::mutex> lock(receive_lock_);
+    return (is_running() && inbound_.front(size) != nullptr);
+}
+
+
+bool networking::shm::transfer(const networking::socket_t& sock, void* const data, const std::size_t& size)
+{
+    if (!is_destination() || !is_running() || data == nullptr || size == 0) {
+        return false;
+    }
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const std::chrono::steady_clock::time_point deadline = start + operation_timeout_;
+    bool sent = false;
+    bool is_expired = false;
+    int error = 0;
+
+    std::shared_lock<std::shared_mutex> lock(destination_lock_);
+    while (!(sent = outbound_.try_push(data, size)) && (error = errno) == EAGAIN && is_running() && is_destination())
+    {
+        if (operation_timeout_.count() > 0 && std::chrono::steady_clock::now() >= deadline)
+        {
+            is_expired = true;
+            break;
+        }
+
+        outbound_.wait_writable(slice(deadline, operation_timeout_.count() > 0));
+    }
+    lock.unlock();
+
+    if (is_expired)
+    {
+        last_error_ = networking::error::TIMEOUT_ERROR;
+        make_log(last_error_, destination_name());
+        return false;
+    }
+    else if (!sent && error == EMSGSIZE)
+    {
+        last_error_ = networking::error::TRANSFER_ERROR;
+        const char* message = make_log(last_error_, "message of " + std::to_string(size) + " B does not fit a " +
+            std::to_string(outbound_.slot_size()) + " B slot");
+        throw networking::networking_error(message);
+    }
+    else if (!sent) {
+        return false;
+    }
+
+    metrics_.record_transfer(size, elapsed_ns(start));
+    make_log(networking::netbase::log::DATA_TRANSMITTED_LOG, "TX: " + std::to_string(size));
+    return true;
+}
+
+
+bool networking::shm::receive(const networking::socket_t& sock, void* const data, const std::size_t& size)
+{
+    bool received = false;
+    if (is_running())
+    {
+        std::unique_lock<std::mutex> lock(receive_lock_);
+
+        std::size_t payload_size = 0;
+        const unsigned char* const payload = inbound_.front(payload_size);
+        if (payload != nullptr)
+        {
+            const std::size_t copied = std::min(size, payload_size);
+            std::memcpy(data, payload, copied);
+            inbound_.pop();
+            lock.unlock();
+
+            make_log(networking::netbase::log::DATA_RECEIVED_LOG, "RX: " + std::to_string(copied));
+            received = (copied == size);
+        }
+    }
+
+    return received;
+}
+
+
+// Waits until a message is at the front of the ring, spinning first and then sleeping until a
+// producer wakes this endpoint or the operation timeout expires.
+void networking::shm::receive_byte_count(const networking::socket_t& sock, std::size_t& count)
+{
+    count = 0;
+    if (!is_running()) {
+        return;
+    }
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const std::chrono::steady_clock::time_point deadline = start + operation_timeout_;
+    bool is_expired = false;
+
+    std::unique_lock<std::mutex> lock(receive_lock_);
+    while (is_running() && inbound_.front(count) == nullptr)
+    {
+        if (operation_timeout_.count() > 0 && std::chrono::steady_clock::now() >= deadline)
+        {
+            is_expired = true;
+            break;
+        }
+
+        inbound_.wait_readable(slice(deadline, operation_timeout_.count() > 0));
+    }
+
+    if (inbound_.front(count) == nullptr) { count = 0; }
+    lock.unlock();
+
+    if (is_expired)
+    {
+        last_error_ = networking::error::TIMEOUT_ERROR;
+        make_log(last_error_, name_);
+    }
+    else if (count > 0) {
+        metrics_.record_receive(count, elapsed_ns(start));
+    }
+}
+
+
+std::chrono::milliseconds networking::shm::slice(const std::chrono::steady_clock::time_point& deadline, const bool& is_bounded) const
+{
+    if (!is_bounded) {
+        return WAIT_SLICE;
+    }
+
+    const std::chrono::milliseconds left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    return std::clamp(left, std::chrono::milliseconds(0), WAIT_SLICE);
+}
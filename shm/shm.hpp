@@ -0,0 +1,128 @@
+#ifndef __NETWORKING_SHM_HPP__
+#define __NETWORKING_SHM_HPP__
+#include "netbase.hpp"
+#include "networking_error.hpp"
+#include "framer.hpp"
+#include "shm_ring.hpp"
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+
+namespace networking
+{
+    // Same-host peer that exchanges messages through shared memory instead of a socket. Each
+    // endpoint owns the ring named after it and receives from it; transfer() writes into the
+    // destination's ring, which any number of endpoints may share. Messages are copied once
+    // into the ring and once out of it (receive_frames() reads them in place), and no system
+    // call is made while the other side is busy. A message must fit into one slot. Only one
+    // thread may receive from an endpoint at a time.
+    class shm : public netbase
+    {
+        public:
+            static constexpr std::size_t DEFAULT_SLOT_SIZE = 4096 - 16;
+            static constexpr std::size_t DEFAULT_SLOTS_COUNT = 1024;
+
+        public:
+            shm() = default;
+            shm(const std::string& name, const std::string& log_file_path = "",
+                const std::size_t& slot_size = DEFAULT_SLOT_SIZE, const std::size_t& slots_count = DEFAULT_SLOTS_COUNT);
+            shm(const shm& obj) = delete;
+            shm(shm&& obj) = delete;
+            ~shm();
+
+            shm& operator=(const shm& obj) = delete;
+            shm& operator=(shm&& obj) = delete;
+
+            void start() override;
+            void reset() override;
+            void end() override;
+            void set_destination(const std::string& name);
+            void unset_destination();
+            bool is_running() const override;
+            bool is_data_to_receive() const;
+            bool wait_readable(const std::chrono::milliseconds& timeout = std::chrono::milliseconds(-1));
+            bool wait_writable(const std::chrono::milliseconds& timeout = std::chrono::milliseconds(-1));
+            std::size_t receive_frames(const networking::framer::frame_callback& on_frame);
+            bool is_destination() const;
+            std::string name() const;
+            std::string destination_name() const;
+            std::size_t slot_size() const;
+            std::size_t slots_count() const;
+
+            template<typename T>
+            bool transfer(T* const data, const std::size_t& count)
+            {
+                return transfer(server_.socket_, data, (sizeof(T) * count));
+            }
+
+
+            template<typename T, typename RT>
+            RT receive()
+            {
+                std::size_t count = 0;
+                receive_byte_count(server_.socket_, count);
+
+                if (count % sizeof(T) != 0) {
+                    reject_message(server_.socket_, count, sizeof(T));
+                }
+                else if (count > 0)
+                {
+                    RT buffer(count / sizeof(T));
+                    if (receive(server_.socket_, buffer.data(), count))
+                    {
+                        return buffer;
+                    }
+                }
+
+                return RT();
+            }
+
+
+        private:
+            bool is_data_to_receive(const networking::socket_t& sock) const override;
+            bool receive(const networking::socket_t& sock, void* const data, const std::size_t& size) override;
+            bool transfer(const networking::socket_t& sock, void* const data, const std::size_t& size) override;
+            void receive_byte_count(const networking::socket_t& sock, std::size_t& count) override;
+            std::chrono::milliseconds slice(const std::chrono::steady_clock::time_point& deadline, const bool& is_bounded) const;
+
+            std::string name_;
+            std::string destination_name_;
+            std::size_t slot_size_ = DEFAULT_SLOT_SIZE;
+            std::size_t slots_count_ = DEFAULT_SLOTS_COUNT;
+            std::atomic<bool> is_running_ = false;
+            std::atomic<bool> is_destination_ = false;
+            networking::shm_ring inbound_;
+            networking::shm_ring outbound_;
+            mutable std::mutex receive_lock_;
+            mutable std::shared_mutex destination_lock_;
+    };
+}
+
+
+inline bool networking::shm::is_running() const
+{
+    return is_running_.load(std::memory_order_acquire);
+}
+
+inline std::string networking::shm::name() const
+{
+    return name_;
+}
+
+inline std::size_t networking::shm::slot_size() const
+{
+    return slot_size_;
+}
+
+inline std::size_t networking::shm::slots_count() const
+{
+    return slots_count_;
+}
+
+
+#endif
@@ -0,0 +1,363 @@
+#include "shm_ring.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+
+namespace
+{
+    static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t) && std::atomic<std::uint32_t>::is_always_lock_free,
+        "futex words must be plain 32-bit integers");
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "ring counters must be address-free across processes");
+
+    std::string segment_path(const std::string& name)
+    {
+        return (!name.empty() && name[0] == '/') ? name : '/' + name;
+    }
+
+    // The segment is shared between processes, so the futexes cannot be process-private.
+    void futex_wait(std::atomic<std::uint32_t>& word, const std::uint32_t& value, const std::chrono::milliseconds& timeout)
+    {
+        timespec relative = {0};
+        relative.tv_sec = timeout.count() / 1000;
+        relative.tv_nsec = (timeout.count() % 1000) * 1000000;
+
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, value,
+            (timeout.count() < 0) ? nullptr : &relative, nullptr, 0);
+    }
+
+    void futex_wake(std::atomic<std::uint32_t>& word, const int& count)
+    {
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE, count, nullptr, nullptr, 0);
+    }
+
+    // Spinning only pays off when the other side runs on another CPU at the same time.
+    std::size_t spin_count()
+    {
+        static const std::size_t count = (std::thread::hardware_concurrency() > 1) ? networking::shm_ring::SPIN_COUNT : 0;
+        return count;
+    }
+
+    void cpu_relax()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+}
+
+
+networking::shm_ring::~shm_ring()
+{
+    close();
+}
+
+
+bool networking::shm_ring::create(const std::string& name, const std::size_t& slot_size, const std::size_t& slots_count)
+{
+    close();
+
+    const std::size_t slot_stride = (sizeof(slot) + slot_size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+    if (slot_size == 0 || slots_count == 0 || (slots_count & (slots_count - 1)) != 0 ||
+        slot_stride > (SIZE_MAX - SLOTS_OFFSET) / slots_count)
+    {
+        errno = EINVAL;
+        return false;
+    }
+
+    const std::string path = segment_path(name);
+    int fd = shm_open(path.data(), O_CREAT | O_EXCL | O_RDWR, 0600);
+
+    if (fd == -1 && errno == EEXIST)
+    {
+        // A segment whose owner died without unlinking it would otherwise block the name forever.
+        networking::shm_ring stale;
+        if (stale.open(path) && kill(stale.header_->owner_, 0) == -1 && errno == ESRCH)
+        {
+            stale.close();
+            shm_unlink(path.data());
+            fd = shm_open(path.data(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        }
+        else { errno = EEXIST; }
+    }
+
+    if (fd == -1) {
+        return false;
+    }
+
+    const std::size_t size = SLOTS_OFFSET + slot_stride * slots_count;
+    if (ftruncate(fd, size) == -1 || !map(fd, size))
+    {
+        const int error = errno;
+        ::close(fd);
+        shm_unlink(path.data());
+        errno = error;
+        return false;
+    }
+    ::close(fd);
+
+    new (header_) header();
+    header_->slot_size_ = slot_size;
+    header_->slots_count_ = slots_count;
+    header_->slot_stride_ = slot_stride;
+    header_->owner_ = getpid();
+
+    for (std::size_t i = 0; i < slots_count; ++i) {
+        new (slot_at(i)) slot{{i}, 0};
+    }
+
+    header_->magic_.store(MAGIC, std::memory_order_release);
+    name_ = path;
+    is_owner_ = true;
+    return true;
+}
+
+
+bool networking::shm_ring::open(const std::string& name)
+{
+    close();
+
+    const std::string path = segment_path(name);
+    const int fd = shm_open(path.data(), O_RDWR, 0);
+    if (fd == -1) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == -1 || static_cast<std::size_t>(info.st_size) < SLOTS_OFFSET ||
+        !map(fd, static_cast<std::size_t>(info.st_size)))
+    {
+        const int error = (errno != 0) ? errno : EPROTO;
+        ::close(fd);
+        errno = error;
+        return false;
+    }
+    ::close(fd);
+
+    const std::uint64_t slots_count = header_->slots_count_;
+    if (header_->magic_.load(std::memory_order_acquire) != MAGIC || slots_count == 0 ||
+        (slots_count & (slots_count - 1)) != 0 || header_->slot_stride_ < sizeof(slot) + header_->slot_size_ ||
+        header_->slot_stride_ > (mapped_size_ - SLOTS_OFFSET) / slots_count)
+    {
+        close();
+        errno = EPROTO;
+        return false;
+    }
+
+    name_ = path;
+    return true;
+}
+
+
+void networking::shm_ring::close()
+{
+    if (header_ != nullptr)
+    {
+        munmap(header_, mapped_size_);
+        if (is_owner_) { shm_unlink(name_.data()); }
+
+        header_ = nullptr;
+        mapped_size_ = 0;
+        name_.clear();
+        is_owner_ = false;
+    }
+}
+
+
+bool networking::shm_ring::try_push(const void* const data, const std::size_t& size)
+{
+    if (header_ == nullptr || size > header_->slot_size_)
+    {
+        errno = (header_ == nullptr) ? EBADF : EMSGSIZE;
+        return false;
+    }
+
+    slot* target = nullptr;
+    std::uint64_t position = header_->head_.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        target = slot_at(position);
+        const std::uint64_t sequence = target->sequence_.load(std::memory_order_acquire);
+        const std::int64_t difference = static_cast<std::int64_t>(sequence - position);
+
+        if (difference == 0)
+        {
+            if (header_->head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) { break; }
+        }
+        else if (difference < 0)
+        {
+            errno = EAGAIN;
+            return false;
+        }
+        else { position = header_->head_.load(std::memory_order_relaxed); }
+    }
+
+    target->size_ = size;
+    std::memcpy(reinterpret_cast<unsigned char*>(target) + sizeof(slot), data, size);
+    target->sequence_.store(position + 1, std::memory_order_release);
+
+    // Pairs with the fence in wait_readable(): either the consumer sees the message before it
+    // sleeps or this side sees it waiting.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (header_->is_consumer_waiting_.load(std::memory_order_relaxed) != 0)
+    {
+        header_->readable_.fetch_add(1, std::memory_order_release);
+        futex_wake(header_->readable_, 1);
+    }
+
+    return true;
+}
+
+
+const unsigned char* networking::shm_ring::front(std::size_t& size) const
+{
+    if (!is_readable()) {
+        return nullptr;
+    }
+
+    const slot* const source = slot_at(header_->tail_.load(std::memory_order_relaxed));
+    size = static_cast<std::size_t>(std::min<std::uint64_t>(source->size_, header_->slot_size_));
+    return reinterpret_cast<const unsigned char*>(source) + sizeof(slot);
+}
+
+
+void networking::shm_ring::pop()
+{
+    if (is_readable())
+    {
+        const std::uint64_t position = header_->tail_.load(std::memory_order_relaxed);
+        slot_at(position)->sequence_.store(position + header_->slots_count_, std::memory_order_release);
+        header_->tail_.store(position + 1, std::memory_order_release);
+        notify_writable();
+    }
+}
+
+
+bool networking::shm_ring::wait_readable(const std::chrono::milliseconds& timeout)
+{
+    if (header_ == nullptr) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < spin_count(); ++i)
+    {
+        if (is_readable()) { return true; }
+        cpu_relax();
+    }
+
+    if (timeout.count() == 0) {
+        return is_readable();
+    }
+
+    const std::uint32_t value = header_->readable_.load(std::memory_order_acquire);
+    header_->is_consumer_waiting_.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (!is_readable()) {
+        futex_wait(header_->readable_, value, timeout);
+    }
+
+    header_->is_consumer_waiting_.store(0, std::memory_order_relaxed);
+    return is_readable();
+}
+
+
+bool networking::shm_ring::wait_writable(const std::chrono::milliseconds& timeout)
+{
+    if (header_ == nullptr) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < spin_count(); ++i)
+    {
+        if (is_writable()) { return true; }
+        cpu_relax();
+    }
+
+    if (timeout.count() == 0) {
+        return is_writable();
+    }
+
+    const std::uint32_t value = header_->writable_.load(std::memory_order_acquire);
+    header_->producers_waiting_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (!is_writable()) {
+        futex_wait(header_->writable_, value, timeout);
+    }
+
+    header_->producers_waiting_.fetch_sub(1, std::memory_order_relaxed);
+    return is_writable();
+}
+
+
+// Releases every thread sleeping in this mapping, so it can notice the endpoint is closing.
+void networking::shm_ring::wake_all()
+{
+    if (header_ != nullptr)
+    {
+        header_->readable_.fetch_add(1, std::memory_order_release);
+        futex_wake(header_->readable_, INT_MAX);
+        header_->writable_.fetch_add(1, std::memory_order_release);
+        futex_wake(header_->writable_, INT_MAX);
+    }
+}
+
+
+bool networking::shm_ring::map(const int& fd, const std::size_t& size)
+{
+    void* const address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        return false;
+    }
+
+    header_ = static_cast<header*>(address);
+    mapped_size_ = size;
+    return true;
+}
+
+
+bool networking::shm_ring::is_readable() const
+{
+    if (header_ == nullptr) {
+        return false;
+    }
+
+    const std::uint64_t position = header_->tail_.load(std::memory_order_relaxed);
+    return (slot_at(position)->sequence_.load(std::memory_order_acquire) == position + 1);
+}
+
+
+bool networking::shm_ring::is_writable() const
+{
+    if (header_ == nullptr) {
+        return false;
+    }
+
+    const std::uint64_t position = header_->head_.load(std::memory_order_relaxed);
+    return (static_cast<std::int64_t>(slot_at(position)->sequence_.load(std::memory_order_acquire) - position) >= 0);
+}
+
+
+void networking::shm_ring::notify_writable()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (header_->producers_waiting_.load(std::memory_order_relaxed) != 0)
+    {
+        header_->writable_.fetch_add(1, std::memory_order_release);
+        futex_wake(header_->writable_, INT_MAX);
+    }
+}
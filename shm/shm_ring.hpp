@@ -0,0 +1,114 @@
+#ifndef __NETWORKING_SHM_RING_HPP__
+#define __NETWORKING_SHM_RING_HPP__
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <string>
+#include <sys/types.h>
+
+
+namespace networking
+{
+    // Bounded multi-producer, single-consumer message queue in a named POSIX shared memory
+    // segment. Every message takes one cache-line aligned slot; producers claim slots with a
+    // ticket counter and publish them through a per-slot sequence number, so neither side takes
+    // a lock. A side that finds nothing to do spins for a while and then sleeps on a futex in
+    // the segment, which the other side only wakes when someone is actually asleep.
+    class shm_ring
+    {
+        public:
+            static constexpr std::size_t CACHE_LINE_SIZE = 64;
+            static constexpr std::size_t SPIN_COUNT = 4096;
+
+        public:
+            shm_ring() = default;
+            shm_ring(const shm_ring& obj) = delete;
+            shm_ring(shm_ring&& obj) = delete;
+            ~shm_ring();
+
+            shm_ring& operator=(const shm_ring& obj) = delete;
+            shm_ring& operator=(shm_ring&& obj) = delete;
+
+            // Both return false with errno set; create() takes over a segment left behind by a
+            // process that no longer exists, but not one that is still in use.
+            bool create(const std::string& name, const std::size_t& slot_size, const std::size_t& slots_count);
+            bool open(const std::string& name);
+            void close();
+            bool is_open() const;
+
+            bool try_push(const void* const data, const std::size_t& size);
+            const unsigned char* front(std::size_t& size) const;
+            void pop();
+
+            bool wait_readable(const std::chrono::milliseconds& timeout);
+            bool wait_writable(const std::chrono::milliseconds& timeout);
+            void wake_all();
+
+            std::size_t slot_size() const;
+            std::size_t slots_count() const;
+
+
+        private:
+            struct header
+            {
+                std::atomic<std::uint64_t> magic_;
+                std::uint64_t slot_size_;
+                std::uint64_t slots_count_;
+                std::uint64_t slot_stride_;
+                pid_t owner_;
+
+                alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> head_;
+                alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> tail_;
+                alignas(CACHE_LINE_SIZE) std::atomic<std::uint32_t> readable_;
+                std::atomic<std::uint32_t> is_consumer_waiting_;
+                alignas(CACHE_LINE_SIZE) std::atomic<std::uint32_t> writable_;
+                std::atomic<std::uint32_t> producers_waiting_;
+            };
+
+            struct slot
+            {
+                std::atomic<std::uint64_t> sequence_;
+                std::uint64_t size_;
+            };
+
+            static constexpr std::uint64_t MAGIC = 0x4E45544B53484D31;
+            static constexpr std::size_t SLOTS_OFFSET = (sizeof(header) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+
+            bool map(const int& fd, const std::size_t& size);
+            slot* slot_at(const std::uint64_t& position) const;
+            bool is_readable() const;
+            bool is_writable() const;
+            void notify_writable();
+
+            header* header_ = nullptr;
+            std::size_t mapped_size_ = 0;
+            std::string name_;
+            bool is_owner_ = false;
+    };
+}
+
+
+inline bool networking::shm_ring::is_open() const
+{
+    return (header_ != nullptr);
+}
+
+inline std::size_t networking::shm_ring::slot_size() const
+{
+    return (header_ != nullptr) ? header_->slot_size_ : 0;
+}
+
+inline std::size_t networking::shm_ring::slots_count() const
+{
+    return (header_ != nullptr) ? header_->slots_count_ : 0;
+}
+
+inline networking::shm_ring::slot* networking::shm_ring::slot_at(const std::uint64_t& position) const
+{
+    unsigned char* const slots = reinterpret_cast<unsigned char*>(header_) + SLOTS_OFFSET;
+    return reinterpret_cast<slot*>(slots + (position & (header_->slots_count_ - 1)) * header_->slot_stride_);
+}
+
+
+#endif
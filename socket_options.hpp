@@ -0,0 +1,26 @@
+#ifndef __NETWORKING_SOCKET_OPTIONS_HPP__
+#define __NETWORKING_SOCKET_OPTIONS_HPP__
+#include <optional>
+#include <string>
+
+
+namespace networking
+{
+    // Unset fields leave the kernel default untouched. TCP level options are ignored
+    // for datagram and local sockets, multicast options for everything but udp.
+    struct socket_options
+    {
+        std::optional<bool> no_delay_;          // TCP_NODELAY
+        std::optional<bool> cork_;              // TCP_CORK
+        std::optional<bool> quick_ack_;         // TCP_QUICKACK, re-armed after every receive
+        std::optional<int> send_buffer_;        // SO_SNDBUF [B], the kernel reports back twice the value
+        std::optional<int> receive_buffer_;     // SO_RCVBUF [B], the kernel reports back twice the value
+        std::optional<int> busy_poll_;          // SO_BUSY_POLL [us]
+        std::optional<int> multicast_ttl_;      // IP_MULTICAST_TTL, 1 keeps datagrams on the local network
+        std::optional<bool> multicast_loop_;    // IP_MULTICAST_LOOP, also deliver to groups joined on this host
+        std::optional<std::string> multicast_interface_;    // IP_MULTICAST_IF, IPv4 address of the outgoing interface
+    };
+}
+
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef __NETWORKING_CONNECTION_STATE_HPP__
+#define __NETWORKING_CONNECTION_STATE_HPP__
+#include "metrics.hpp"
+#include "framer.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace networking
+{
+    // What a connection keeps between operations. It is shared, so an operation holds it until it
+    // returns even if the connection is closed, and its descriptor reused, in the meantime.
+    // read_lock_ guards the framer and write_lock_ the write buffer; both are recursive so a frame
+    // callback may read or write again. Taken in that order, and before lock_. Once is_closed_ is
+    // set no operation starts on the descriptor, and it is only closed after both locks have been
+    // free since, so operations already under way have returned.
+    struct connection_state
+    {
+        public:
+            networking::connection_metrics metrics_;
+            std::recursive_mutex read_lock_;
+            std::recursive_mutex write_lock_;
+            std::unique_ptr<networking::framer> framer_;
+            std::vector<unsigned char> write_buffer_;
+            std::atomic<bool> is_closed_ = false;
+    };
+}
+
+
+#endif
@@ -0,0 +1,82 @@
+#include "connection_table.hpp"
+#include "netbase.hpp"
+#include <cstring>
+#include <sstream>
+#include <arpa/inet.h>
+
+
+networking::connection_table::entry* networking::connection_table::insert(const networking::socket_t& sock, const sockaddr_in& connection)
+{
+    if (sock < 0) { return nullptr; }
+
+    const std::size_t chunk = static_cast<std::size_t>(sock) / CHUNK_SIZE;
+    if (chunk >= chunks_.size()) { chunks_.resize(chunk + 1); }
+    if (!chunks_[chunk]) { chunks_[chunk].reset(new entry[CHUNK_SIZE]); }
+
+    entry& e = chunks_[chunk][static_cast<std::size_t>(sock) % CHUNK_SIZE];
+    if (e.socket_ == networking::socket_t::NONE) { size_ += 1; }
+
+    e.reset();
+    e.connection_ = connection;
+    e.socket_ = sock;
+    e.state_ = std::make_shared<networking::connection_state>();
+
+    return &e;
+}
+
+
+networking::connection_table::entry* networking::connection_table::find(const networking::socket_t& sock)
+{
+    if (sock < 0) { return nullptr; }
+
+    const std::size_t chunk = static_cast<std::size_t>(sock) / CHUNK_SIZE;
+    if (chunk >= chunks_.size() || !chunks_[chunk]) { return nullptr; }
+
+    entry& e = chunks_[chunk][static_cast<std::size_t>(sock) % CHUNK_SIZE];
+    if (e.socket_ == networking::socket_t::NONE) { return nullptr; }
+
+    return &e;
+}
+
+
+const networking::connection_table::entry* networking::connection_table::find(const networking::socket_t& sock) const
+{
+    return const_cast<networking::connection_table*>(this)->find(sock);
+}
+
+
+bool networking::connection_table::erase(const networking::socket_t& sock)
+{
+    entry* const e = find(sock);
+    if (e == nullptr) { return false; }
+
+    e->socket_ = networking::socket_t::NONE;
+    size_ -= 1;
+
+    return true;
+}
+
+
+void networking::connection_table::clear()
+{
+    chunks_.clear();
+    size_ = 0;
+}
+
+
+
+void networking::connection_table::entry::reset()
+{
+    memset(&connection_, 0, sizeof(connection_));
+    socket_ = networking::socket_t::NONE;
+    state_.reset();
+    idle_timer_ = networking::timer_wheel::NONE;
+}
+
+
+std::string networking::connection_table::entry::info() const
+{
+    std::stringstream s_info;
+    s_info << "IP address: " << networking::netbase::address_string(connection_.sin_addr) << "   Port: " << ntohs(connection_.sin_port) << "   Socket: " << socket_;
+    return s_info.str();
+}
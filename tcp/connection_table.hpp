@@ -0,0 +1,87 @@
+#ifndef __NETWORKING_CONNECTION_TABLE_HPP__
+#define __NETWORKING_CONNECTION_TABLE_HPP__
+#include "socket.hpp"
+#include "metrics.hpp"
+#include "timer_wheel.hpp"
+#include "connection_state.hpp"
+#include <cinttypes>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+
+
+namespace networking
+{
+    // Connections are stored in fixed-size chunks of contiguous slots indexed directly by
+    // the socket descriptor, so lookup, insert and erase are O(1) and a slot never moves
+    // while its socket is connected. The table is not synchronized on its own.
+    class connection_table
+    {
+        public:
+            static constexpr std::size_t CHUNK_SIZE = 256;
+
+            struct entry
+            {
+                public:
+                    void reset();
+                    std::string info() const;
+
+                    sockaddr_in connection_ = {0};
+                    networking::socket_t socket_;
+                    std::shared_ptr<networking::connection_state> state_;
+                    networking::timer_wheel::timer_id idle_timer_ = networking::timer_wheel::NONE;
+            };
+
+        public:
+            connection_table() = default;
+            connection_table(const connection_table& obj) = delete;
+            connection_table(connection_table&& obj) = delete;
+            ~connection_table() = default;
+
+            connection_table& operator=(const connection_table& obj) = delete;
+            connection_table& operator=(connection_table&& obj) = delete;
+
+            entry* insert(const networking::socket_t& sock, const sockaddr_in& connection);
+            entry* find(const networking::socket_t& sock);
+            const entry* find(const networking::socket_t& sock) const;
+            bool erase(const networking::socket_t& sock);
+            void clear();
+            std::size_t size() const;
+            bool empty() const;
+
+            template<typename F>
+            void for_each(F f) const
+            {
+                for (const auto& chunk : chunks_)
+                {
+                    if (chunk)
+                    {
+                        for (std::size_t i = 0; i < CHUNK_SIZE; ++i) {
+                            if (chunk[i].socket_ != networking::socket_t::NONE) { f(chunk[i]); }
+                        }
+                    }
+                }
+            }
+
+
+        private:
+            std::vector<std::unique_ptr<entry[]>> chunks_;
+            std::size_t size_ = 0;
+    };
+}
+
+
+inline std::size_t networking::connection_table::size() const
+{
+    return size_;
+}
+
+inline bool networking::connection_table::empty() const
+{
+    return (size_ == 0);
+}
+
+
+#endif
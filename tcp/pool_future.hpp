@@ -0,0 +1,300 @@
+#ifndef __POOL_FUTURE_HPP__
+#define __POOL_FUTURE_HPP__
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+// Shared state between a submitted task and its pool_future. Released states are kept in a
+// small per-thread free list that spills to and refills from a shared one in batches, since
+// the last release often happens on a worker rather than on the submitting thread. Steady
+// submit/get traffic therefore does not touch the allocator.
+template<typename R>
+class pool_state
+{
+    public:
+        static constexpr std::size_t CACHE_SIZE = 64;
+        static constexpr std::size_t SHARED_CACHE_SIZE = 1024;
+
+    public:
+        pool_state(const pool_state& obj) = delete;
+        pool_state(pool_state&& obj) = delete;
+
+        pool_state& operator=(const pool_state& obj) = delete;
+        pool_state& operator=(pool_state&& obj) = delete;
+
+        static pool_state* acquire()
+        {
+            std::vector<pool_state*>& states = free_list().states_;
+            pool_state* state = nullptr;
+
+            if (states.empty()) 
+            {
+                shared_cache& shared = shared_list();
+                std::unique_lock<std::mutex> lock(shared.lock_);
+                const std::size_t count = std::min(shared.states_.size(), CACHE_SIZE / 2);
+                states.insert(states.end(), shared.states_.end() - count, shared.states_.end());
+                shared.states_.resize(shared.states_.size() - count);
+            }
+
+            if (states.empty()) { state = new pool_state; }
+            else
+            {
+                state = states.back();
+                states.pop_back();
+            }
+
+            state->refs_.store(2, std::memory_order_relaxed);
+            return state;
+        }
+
+        void release()
+        {
+            if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                value_.reset();
+                error_ = nullptr;
+                is_ready_.store(false, std::memory_order_relaxed);
+
+                std::vector<pool_state*>& states = free_list().states_;
+                states.push_back(this);
+
+                if (states.size() > CACHE_SIZE)
+                {
+                    shared_cache& shared = shared_list();
+                    std::unique_lock<std::mutex> lock(shared.lock_);
+                    while (states.size() > CACHE_SIZE / 2)
+                    {
+                        if (shared.states_.size() < SHARED_CACHE_SIZE) { shared.states_.push_back(states.back()); }
+                        else { delete states.back(); }
+                        states.pop_back();
+                    }
+                }
+            }
+        }
+
+        template<typename F>
+        void run(F& f)
+        {
+            try
+            {
+                if constexpr (std::is_void_v<R>) 
+                {
+                    f();
+                    value_.emplace(true);
+                }
+                else { value_.emplace(f()); }
+            }
+            catch (...) 
+            {
+                error_ = std::current_exception();
+            }
+
+            make_ready();
+        }
+
+        void fail(const std::exception_ptr& error)
+        {
+            error_ = error;
+            make_ready();
+        }
+
+        R get()
+        {
+            wait();
+            if (error_) { std::rethrow_exception(error_); }
+
+            if constexpr (!std::is_void_v<R>) {
+                return std::move(*value_);
+            }
+        }
+
+        void wait()
+        {
+            if (!is_ready())
+            {
+                std::unique_lock<std::mutex> lock(lock_);
+                ready_cv_.wait(lock, [this]() { return is_ready(); });
+            }
+        }
+
+        template<typename Rep, typename Period>
+        bool wait_for(const std::chrono::duration<Rep, Period>& timeout)
+        {
+            if (!is_ready())
+            {
+                std::unique_lock<std::mutex> lock(lock_);
+                return ready_cv_.wait_for(lock, timeout, [this]() { return is_ready(); });
+            }
+
+            return true;
+        }
+
+        bool is_ready() const
+        {
+            return is_ready_.load(std::memory_order_acquire);
+        }
+
+
+    private:
+        using value_type = std::conditional_t<std::is_void_v<R>, bool, R>;
+
+        struct cache
+        {
+            ~cache()
+            {
+                for (auto& state : states_) { delete state; }
+            }
+
+            std::vector<pool_state*> states_;
+        };
+
+        struct shared_cache
+        {
+            ~shared_cache()
+            {
+                for (auto& state : states_) { delete state; }
+            }
+
+            std::mutex lock_;
+            std::vector<pool_state*> states_;
+        };
+
+        pool_state() = default;
+        ~pool_state() = default;
+
+        static cache& free_list()
+        {
+            thread_local cache states;
+            return states;
+        }
+
+        static shared_cache& shared_list()
+        {
+            static shared_cache states;
+            return states;
+        }
+
+        void make_ready()
+        {
+            std::unique_lock<std::mutex> lock(lock_);
+            is_ready_.store(true, std::memory_order_release);
+            ready_cv_.notify_all();
+        }
+
+        std::optional<value_type> value_;
+        std::exception_ptr error_;
+        std::atomic<bool> is_ready_ = false;
+        std::atomic<int> refs_ = 0;
+        std::mutex lock_;
+        std::condition_variable ready_cv_;
+};
+
+
+template<typename R>
+class pool_future
+{
+    public:
+        pool_future() = default;
+        explicit pool_future(pool_state<R>* const state) : state_(state) {}
+        pool_future(const pool_future& obj) = delete;
+        pool_future(pool_future&& obj) noexcept : state_(std::exchange(obj.state_, nullptr)) {}
+        ~pool_future() { release(); }
+
+        pool_future& operator=(const pool_future& obj) = delete;
+        pool_future& operator=(pool_future&& obj) noexcept
+        {
+            if (this != &obj)
+            {
+                release();
+                state_ = std::exchange(obj.state_, nullptr);
+            }
+            return *this;
+        }
+
+        R get()
+        {
+            if (state_ == nullptr) { throw std::future_error(std::future_errc::no_state); }
+
+            pool_state<R>* const state = std::exchange(state_, nullptr);
+            struct releaser { pool_state<R>* state_; ~releaser() { state_->release(); } } guard{state};
+            return state->get();
+        }
+
+        void wait() const
+        {
+            if (state_ != nullptr) { state_->wait(); }
+        }
+
+        template<typename Rep, typename Period>
+        bool wait_for(const std::chrono::duration<Rep, Period>& timeout) const
+        {
+            return (state_ != nullptr && state_->wait_for(timeout));
+        }
+
+        bool is_ready() const
+        {
+            return (state_ != nullptr && state_->is_ready());
+        }
+
+        bool valid() const
+        {
+            return (state_ != nullptr);
+        }
+
+
+    private:
+        void release()
+        {
+            if (state_ != nullptr) { std::exchange(state_, nullptr)->release(); }
+        }
+
+        pool_state<R>* state_ = nullptr;
+};
+
+
+// Task side of submit(): fulfils the state when run, or breaks the promise if the pool
+// drops the task (stop(), expired deadline) before it ever runs.
+template<typename R, typename F>
+class pool_call
+{
+    public:
+        pool_call(pool_state<R>* const state, F&& f) : state_(state), f_(std::move(f)) {}
+        pool_call(const pool_call& obj) = delete;
+        pool_call(pool_call&& obj) noexcept(std::is_nothrow_move_constructible_v<F>) : state_(std::exchange(obj.state_, nullptr)), f_(std::move(obj.f_)) {}
+        ~pool_call()
+        {
+            if (state_ != nullptr)
+            {
+                state_->fail(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+                state_->release();
+            }
+        }
+
+        pool_call& operator=(const pool_call& obj) = delete;
+        pool_call& operator=(pool_call&& obj) = delete;
+
+        void operator()()
+        {
+            pool_state<R>* const state = std::exchange(state_, nullptr);
+            state->run(f_);
+            state->release();
+        }
+
+
+    private:
+        pool_state<R>* state_;
+        F f_;
+};
+
+
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef __POOL_TASK_HPP__
+#define __POOL_TASK_HPP__
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+class pool_task
+{
+    public:
+        static constexpr std::size_t INLINE_SIZE = 64;
+
+    public:
+        pool_task() = default;
+
+        template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, pool_task>>>
+        pool_task(F&& f)
+        {
+            using callable = std::decay_t<F>;
+            if (is_empty<callable>(f)) {
+                return;
+            }
+
+            if constexpr (is_inline<callable>())
+            {
+                new (storage_) callable(std::forward<F>(f));
+                ops_ = &inline_ops<callable>;
+            }
+            else
+            {
+                *reinterpret_cast<callable**>(storage_) = new callable(std::forward<F>(f));
+                ops_ = &heap_ops<callable>;
+            }
+        }
+
+        pool_task(const pool_task& obj) = delete;
+
+        pool_task(pool_task&& obj) noexcept
+        {
+            take(obj);
+        }
+
+        ~pool_task()
+        {
+            reset();
+        }
+
+        pool_task& operator=(const pool_task& obj) = delete;
+
+        pool_task& operator=(pool_task&& obj) noexcept
+        {
+            if (this != &obj)
+            {
+                reset();
+                take(obj);
+            }
+            return *this;
+        }
+
+        pool_task& operator=(std::nullptr_t)
+        {
+            reset();
+            return *this;
+        }
+
+        void operator()()
+        {
+            ops_->invoke_(storage_);
+        }
+
+        explicit operator bool() const
+        {
+            return (ops_ != nullptr);
+        }
+
+        bool is_allocated() const
+        {
+            return (ops_ != nullptr && ops_->is_allocated_);
+        }
+
+
+    private:
+        struct operations
+        {
+            void (*invoke_)(void* storage);
+            void (*move_)(void* to, void* from);
+            void (*destroy_)(void* storage);
+            bool is_allocated_;
+        };
+
+        template<typename F>
+        struct is_std_function : std::false_type {};
+
+        template<typename S>
+        struct is_std_function<std::function<S>> : std::true_type {};
+
+        // An empty std::function or a null pointer leaves the task empty, so it is skipped
+        // instead of throwing on a pool thread.
+        template<typename F>
+        static bool is_empty(const F& f)
+        {
+            if constexpr (std::is_pointer_v<F> || std::is_member_pointer_v<F>) { return (f == nullptr); }
+            else if constexpr (is_std_function<F>::value) { return !f; }
+            else { return false; }
+        }
+
+        template<typename F>
+        static constexpr bool is_inline()
+        {
+            return (sizeof(F) <= INLINE_SIZE && alignof(F) <= alignof(std::max_align_t) && 
+                std::is_nothrow_move_constructible_v<F>);
+        }
+
+        template<typename F>
+        static constexpr operations inline_ops = {
+            [](void* storage) { (*static_cast<F*>(storage))(); },
+            [](void* to, void* from) { new (to) F(std::move(*static_cast<F*>(from))); static_cast<F*>(from)->~F(); },
+            [](void* storage) { static_cast<F*>(storage)->~F(); },
+            false
+        };
+
+        template<typename F>
+        static constexpr operations heap_ops = {
+            [](void* storage) { (**static_cast<F**>(storage))(); },
+            [](void* to, void* from) { *static_cast<F**>(to) = *static_cast<F**>(from); },
+            [](void* storage) { delete *static_cast<F**>(storage); },
+            true
+        };
+
+        void take(pool_task& obj)
+        {
+            if (obj.ops_ != nullptr)
+            {
+                obj.ops_->move_(storage_, obj.storage_);
+                ops_ = obj.ops_;
+                obj.ops_ = nullptr;
+            }
+        }
+
+        void reset()
+        {
+            if (ops_ != nullptr)
+            {
+                ops_->destroy_(storage_);
+                ops_ = nullptr;
+            }
+        }
+
+        alignas(std::max_align_t) unsigned char storage_[INLINE_SIZE];
+        const operations* ops_ = nullptr;
+};
+
+
+
+#endif
@@ -0,0 +1,389 @@
+#include "send_reactor.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+
+
+networking::send_reactor::~send_reactor()
+{
+    stop();
+}
+
+
+bool networking::send_reactor::start()
+{
+    if (run_ == false)
+    {
+        epoll_ = epoll_create1(EPOLL_CLOEXEC);
+        wakeup_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+        epoll_event event = {0};
+        event.events = EPOLLIN;
+        event.data.fd = wakeup_;
+
+        if (epoll_ == -1 || wakeup_ == -1 || epoll_ctl(epoll_, EPOLL_CTL_ADD, wakeup_, &event) == -1)
+        {
+            const int error = errno;
+            if (epoll_ != -1) { ::close(epoll_); }
+            if (wakeup_ != -1) { ::close(wakeup_); }
+            epoll_ = wakeup_ = -1;
+            errno = error;
+            return false;
+        }
+
+        run_ = true;
+        thread_ = std::thread(&send_reactor::run, this);
+    }
+
+    return true;
+}
+
+
+void networking::send_reactor::stop()
+{
+    if (run_)
+    {
+        run_ = false;
+        const std::uint64_t value = 1;
+        if (write(wakeup_, &value, sizeof(value)) == -1) {}
+        thread_.join();
+
+        ::close(epoll_);
+        ::close(wakeup_);
+        epoll_ = wakeup_ = -1;
+
+        std::unique_lock<std::mutex> lock(lock_);
+        queues_.clear();
+    }
+}
+
+
+networking::send_reactor::result networking::send_reactor::post(const networking::socket_t& sock, const iovec* const parts, const std::size_t& count)
+{
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < count; ++i) { total += parts[i].iov_len; }
+
+    const std::shared_ptr<queue> q = find_or_create(sock);
+    lock_.lock();
+    const networking::send_reactor::watermarks limits = limits_;
+    lock_.unlock();
+
+    std::unique_lock<std::mutex> queue_lock(q->lock_);
+    if (q->is_failed_ || q->is_closed_) {
+        return networking::send_reactor::result::FAILED;
+    }
+
+    if (q->bytes_ > 0 && q->bytes_ + total > limits.max_) {
+        return networking::send_reactor::result::FULL;
+    }
+
+    std::size_t sent = 0;
+    if (q->bytes_ == 0)
+    {
+        msghdr message = {0};
+        message.msg_iov = const_cast<iovec*>(parts);
+        message.msg_iovlen = count;
+
+        const ssize_t result = sendmsg(sock, &message, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            const int error = errno;
+            fail(*q);
+            queue_lock.unlock();
+
+            lock_.lock();
+            const networking::send_reactor::error_callback callback = on_error_;
+            lock_.unlock();
+            if (callback) { callback(sock, error); }
+            return networking::send_reactor::result::FAILED;
+        }
+
+        sent = (result > 0) ? static_cast<std::size_t>(result) : 0;
+        if (sent == total) {
+            return networking::send_reactor::result::SENT;
+        }
+    }
+
+    std::vector<unsigned char> chunk;
+    chunk.reserve(total - sent);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const unsigned char* const begin = static_cast<const unsigned char*>(parts[i].iov_base);
+        const std::size_t skip = std::min(sent, parts[i].iov_len);
+        chunk.insert(chunk.end(), begin + skip, begin + parts[i].iov_len);
+        sent -= skip;
+    }
+
+    q->bytes_ += chunk.size();
+    q->chunks_.push_back(std::move(chunk));
+
+    const bool is_high = (!q->is_above_high_ && q->bytes_ >= limits.high_);
+    if (is_high) { q->is_above_high_ = true; }
+    const std::size_t queued = q->bytes_;
+
+    if (!q->is_armed_ && !arm(sock, *q))
+    {
+        const int error = errno;
+        fail(*q);
+        queue_lock.unlock();
+
+        lock_.lock();
+        const networking::send_reactor::error_callback callback = on_error_;
+        lock_.unlock();
+        if (callback) { callback(sock, error); }
+        return networking::send_reactor::result::FAILED;
+    }
+    queue_lock.unlock();
+
+    if (is_high)
+    {
+        lock_.lock();
+        const networking::send_reactor::watermark_callback callback = on_high_;
+        lock_.unlock();
+        if (callback) { callback(sock, queued); }
+    }
+
+    return networking::send_reactor::result::QUEUED;
+}
+
+
+void networking::send_reactor::close(const networking::socket_t& sock)
+{
+    std::shared_ptr<queue> q;
+
+    lock_.lock();
+    const auto it = queues_.find(sock);
+    if (it != queues_.end())
+    {
+        q = it->second;
+        queues_.erase(it);
+    }
+    lock_.unlock();
+
+    if (q)
+    {
+        std::unique_lock<std::mutex> queue_lock(q->lock_);
+        if (q->is_registered_ && epoll_ != -1) { epoll_ctl(epoll_, EPOLL_CTL_DEL, sock, nullptr); }
+        q->is_registered_ = false;
+        q->is_armed_ = false;
+        q->is_closed_ = true;
+        q->chunks_.clear();
+        q->bytes_ = 0;
+    }
+}
+
+
+// Shuts down a socket whose queue failed, unless its owner has closed the queue since, and tells
+// whether it did. Owners close the queue before the socket, so a descriptor that may already be
+// reused is never touched.
+bool networking::send_reactor::shutdown_failed(const networking::socket_t& sock)
+{
+    const std::shared_ptr<queue> q = find(sock);
+    if (q)
+    {
+        std::unique_lock<std::mutex> queue_lock(q->lock_);
+        if (q->is_failed_ && !q->is_closed_)
+        {
+            shutdown(sock, SHUT_RDWR);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+std::size_t networking::send_reactor::queued_bytes(const networking::socket_t& sock) const
+{
+    const std::shared_ptr<queue> q = find(sock);
+    if (q)
+    {
+        std::unique_lock<std::mutex> queue_lock(q->lock_);
+        return q->bytes_;
+    }
+
+    return 0;
+}
+
+
+networking::send_reactor::watermarks networking::send_reactor::limits() const
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    return limits_;
+}
+
+
+void networking::send_reactor::limits(const networking::send_reactor::watermarks& limits)
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    limits_ = limits;
+    limits_.high_ = std::max(limits_.high_, limits_.low_);
+    limits_.max_ = std::max(limits_.max_, limits_.high_);
+}
+
+
+void networking::send_reactor::on_high_watermark(const networking::send_reactor::watermark_callback& callback)
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    on_high_ = callback;
+}
+
+
+void networking::send_reactor::on_low_watermark(const networking::send_reactor::watermark_callback& callback)
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    on_low_ = callback;
+}
+
+
+void networking::send_reactor::on_error(const networking::send_reactor::error_callback& callback)
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    on_error_ = callback;
+}
+
+
+std::shared_ptr<networking::send_reactor::queue> networking::send_reactor::find(const networking::socket_t& sock) const
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    const auto it = queues_.find(sock);
+    return (it != queues_.end()) ? it->second : nullptr;
+}
+
+
+std::shared_ptr<networking::send_reactor::queue> networking::send_reactor::find_or_create(const networking::socket_t& sock)
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    std::shared_ptr<queue>& q = queues_[sock];
+    if (!q) { q = std::make_shared<queue>(); }
+    return q;
+}
+
+
+bool networking::send_reactor::drain(const networking::socket_t& sock, queue& q)
+{
+    while (q.bytes_ > 0)
+    {
+        iovec parts[IOV_COUNT];
+        std::size_t count = 0;
+        for (auto chunk = q.chunks_.begin(); chunk != q.chunks_.end() && count < IOV_COUNT; ++chunk, ++count)
+        {
+            const std::size_t offset = (count == 0) ? q.offset_ : 0;
+            parts[count].iov_base = chunk->data() + offset;
+            parts[count].iov_len = chunk->size() - offset;
+        }
+
+        msghdr message = {0};
+        message.msg_iov = parts;
+        message.msg_iovlen = count;
+
+        const ssize_t result = sendmsg(sock, &message, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (result < 0) {
+            return (errno == EAGAIN || errno == EWOULDBLOCK);
+        }
+
+        std::size_t sent = static_cast<std::size_t>(result);
+        q.bytes_ -= sent;
+        while (sent > 0)
+        {
+            const std::size_t left = q.chunks_.front().size() - q.offset_;
+            if (sent < left)
+            {
+                q.offset_ += sent;
+                sent = 0;
+            }
+            else
+            {
+                sent -= left;
+                q.offset_ = 0;
+                q.chunks_.pop_front();
+            }
+        }
+    }
+
+    return true;
+}
+
+
+bool networking::send_reactor::arm(const networking::socket_t& sock, queue& q)
+{
+    epoll_event event = {0};
+    event.events = EPOLLOUT | EPOLLONESHOT;
+    event.data.fd = sock;
+
+    if (epoll_ctl(epoll_, q.is_registered_ ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, sock, &event) == -1) {
+        return false;
+    }
+
+    q.is_registered_ = true;
+    q.is_armed_ = true;
+    return true;
+}
+
+
+void networking::send_reactor::fail(queue& q)
+{
+    q.is_failed_ = true;
+    q.chunks_.clear();
+    q.bytes_ = 0;
+    q.offset_ = 0;
+}
+
+
+void networking::send_reactor::run()
+{
+    epoll_event events[EVENTS_COUNT];
+
+    while (run_)
+    {
+        const int ready = epoll_wait(epoll_, events, EVENTS_COUNT, -1);
+        if (ready < 0)
+        {
+            if (errno == EINTR) { continue; }
+            break;
+        }
+
+        for (int i = 0; i < ready; ++i)
+        {
+            const int sock = events[i].data.fd;
+            if (sock == wakeup_) {
+                continue;
+            }
+
+            const std::shared_ptr<queue> q = find(sock);
+            if (!q) {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> queue_lock(q->lock_);
+            if (q->is_failed_ || q->is_closed_) {
+                continue;
+            }
+
+            q->is_armed_ = false;
+            int error = 0;
+            if (!drain(sock, *q) || (q->bytes_ > 0 && !arm(sock, *q)))
+            {
+                error = errno;
+                fail(*q);
+            }
+
+            lock_.lock();
+            const bool is_low = (q->is_above_high_ && q->bytes_ <= limits_.low_);
+            const networking::send_reactor::watermark_callback on_low = is_low ? on_low_ : nullptr;
+            const networking::send_reactor::error_callback on_error = (error != 0) ? on_error_ : nullptr;
+            lock_.unlock();
+
+            if (is_low) { q->is_above_high_ = false; }
+            const std::size_t queued = q->bytes_;
+            queue_lock.unlock();
+
+            if (on_error) { on_error(sock, error); }
+            else if (on_low) { on_low(sock, queued); }
+        }
+    }
+}
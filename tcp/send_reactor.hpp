@@ -0,0 +1,107 @@
+#ifndef __NETWORKING_SEND_REACTOR_HPP__
+#define __NETWORKING_SEND_REACTOR_HPP__
+#include "socket.hpp"
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sys/uio.h>
+
+
+namespace networking
+{
+    // Bounded per-socket outbound queues drained by one epoll thread. post() sends directly
+    // while the socket accepts data and queues only the remainder, so the fast path stays
+    // copy-free; once a queue crosses the high watermark the producer is told to back off
+    // and is told again when it drains below the low watermark.
+    class send_reactor
+    {
+        public:
+            struct watermarks
+            {
+                std::size_t low_ = 64 * 1024;
+                std::size_t high_ = 1024 * 1024;
+                std::size_t max_ = 4 * 1024 * 1024;
+            };
+
+            enum class result
+            {
+                SENT, QUEUED, FULL, FAILED
+            };
+
+            using watermark_callback = std::function<void(const networking::socket_t&, const std::size_t&)>;
+            using error_callback = std::function<void(const networking::socket_t&, const int&)>;
+
+        public:
+            send_reactor() = default;
+            send_reactor(const send_reactor& obj) = delete;
+            send_reactor(send_reactor&& obj) = delete;
+            ~send_reactor();
+
+            send_reactor& operator=(const send_reactor& obj) = delete;
+            send_reactor& operator=(send_reactor&& obj) = delete;
+
+            bool start();
+            void stop();
+            networking::send_reactor::result post(const networking::socket_t& sock, const iovec* const parts, const std::size_t& count);
+            void close(const networking::socket_t& sock);
+            bool shutdown_failed(const networking::socket_t& sock);
+            std::size_t queued_bytes(const networking::socket_t& sock) const;
+            networking::send_reactor::watermarks limits() const;
+            void limits(const networking::send_reactor::watermarks& limits);
+            void on_high_watermark(const networking::send_reactor::watermark_callback& callback);
+            void on_low_watermark(const networking::send_reactor::watermark_callback& callback);
+            void on_error(const networking::send_reactor::error_callback& callback);
+            bool is_running() const;
+
+
+        private:
+            struct queue
+            {
+                std::mutex lock_;
+                std::deque<std::vector<unsigned char>> chunks_;
+                std::size_t offset_ = 0;
+                std::size_t bytes_ = 0;
+                bool is_armed_ = false;
+                bool is_registered_ = false;
+                bool is_above_high_ = false;
+                bool is_failed_ = false;
+                bool is_closed_ = false;
+            };
+
+            std::shared_ptr<queue> find(const networking::socket_t& sock) const;
+            std::shared_ptr<queue> find_or_create(const networking::socket_t& sock);
+            bool drain(const networking::socket_t& sock, queue& q);
+            bool arm(const networking::socket_t& sock, queue& q);
+            void fail(queue& q);
+            void run();
+
+            static constexpr std::size_t EVENTS_COUNT = 64;
+            static constexpr std::size_t IOV_COUNT = 64;
+
+            int epoll_ = -1;
+            int wakeup_ = -1;
+            std::atomic<bool> run_ = false;
+            std::thread thread_;
+            std::unordered_map<int, std::shared_ptr<queue>> queues_;
+            networking::send_reactor::watermarks limits_;
+            networking::send_reactor::watermark_callback on_high_;
+            networking::send_reactor::watermark_callback on_low_;
+            networking::send_reactor::error_callback on_error_;
+            mutable std::mutex lock_;
+    };
+}
+
+
+inline bool networking::send_reactor::is_running() const
+{
+    return run_;
+}
+
+
+#endif
@@ -1,24 +1,45 @@
 #include "tcp.hpp"
 #include "networking_error.hpp"
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
 #include <ctime>
+#include <chrono>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
 #include <unistd.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/tcp.h>
 #include <mutex>
 
 
+namespace
+{
+    // Compressed messages are built in, and inflated through, buffers owned by the calling thread.
+    std::vector<unsigned char>& compress_scratch()
+    {
+        thread_local std::vector<unsigned char> scratch;
+        return scratch;
+    }
+
+    std::vector<unsigned char>& decompress_scratch()
+    {
+        thread_local std::vector<unsigned char> scratch;
+        return scratch;
+    }
+}
+
 networking::tcp::~tcp()
 {
 
 }
 
 
-networking::tcp::tcp(const std::string& ip_address, const std::uint16_t& port, const networking::communication& communication_type, const std::string& log_file_path) :
-    networking::netbase(ip_address, port, communication_type, log_file_path)
+networking::tcp::tcp(const std::string& ip_address, const std::uint16_t& port, const networking::communication& communication_type, 
+    const std::string& log_file_path, const networking::socket_options& options) :
+    networking::netbase(ip_address, port, communication_type, log_file_path, options)
 {
 
 }
@@ -42,24 +63,60 @@ void networking::tcp::start()
 bool networking::tcp::receive(const networking::socket_t& sock, void* const data, const std::size_t& size)
 {
     bool received = false;
-    if (is_running())
-    {                 
-        lock_.lock();
-        if (recv(sock, data, size, MSG_WAITALL) < 0)
-        {
-            last_error_ = networking::error::RECEIVE_ERROR;
-            lock_.unlock();
-            const char* message = make_log(last_error_, strerror(errno));
-            throw networking::networking_error(message);
-        }
-        lock_.unlock();
+    const std::shared_ptr<networking::connection_state> state = state_of(sock);
 
-        if (!is_big_endian()) {
-            reverse_byte_order((unsigned char* const) data, size);
+    if (is_running() && state != nullptr && state->framer_ != nullptr)
+    {
+        std::lock_guard<std::recursive_mutex> read_lock(state->read_lock_);
+        if (state->is_closed_) {
+            return false;
         }
-        make_log(networking::netbase::log::DATA_RECEIVED_LOG, "RX: " + std::to_string(size));
 
-        received = true;
+        networking::framer* const parser = state->framer_.get();
+        unsigned char* payload = nullptr;
+        std::size_t payload_size = 0;
+
+        if (parser->front(payload, payload_size) == networking::framer::status::COMPLETE)
+        {
+            const std::uint8_t codec = parser->front_codec();
+            parser->pop();
+
+            std::size_t copied = std::min(size, payload_size);
+            if (codec == 0) {
+                std::memcpy(data, payload, copied);
+            }
+            else
+            {
+                const std::size_t original = original_size(codec, payload, payload_size, *parser);
+                copied = std::min(size, original);
+
+                // Only a caller buffer too small for the whole message goes through the scratch buffer.
+                bool is_inflated = false;
+                if (original > 0 && size >= original) {
+                    is_inflated = decompress(codec, payload, payload_size, static_cast<unsigned char*>(data), original);
+                }
+                else if (original > 0)
+                {
+                    std::vector<unsigned char>& scratch = decompress_scratch();
+                    scratch.resize(original);
+                    is_inflated = decompress(codec, payload, payload_size, scratch.data(), original);
+                    if (is_inflated) { std::memcpy(data, scratch.data(), copied); }
+                }
+
+                if (!is_inflated)
+                {
+                    malformed_frame(sock, &state->metrics_);
+                    return false;
+                }
+            }
+
+            if (!is_big_endian() && parser->is_payload_encoded()) {
+                reverse_byte_order((unsigned char* const) data, copied);
+            }
+            make_log(networking::netbase::log::DATA_RECEIVED_LOG, "RX: " + std::to_string(copied));
+
+            received = (copied == size);
+        }
     }
 
     return received;
@@ -67,46 +124,100 @@ bool networking::tcp::receive(const networking::socket_t& sock, void* const data
 
 
 bool networking::tcp::transfer(const networking::socket_t& sock, void* const data, const std::size_t& size)
+{
+    return transfer_frame(sock, data, size, true);
+}
+
+
+// Sends one frame, in the netbase byte order when is_netbase_order is set and the framing
+// carries it, or as is.
+bool networking::tcp::transfer_frame(const networking::socket_t& sock, void* const data, const std::size_t& size, 
+    const bool& is_netbase_order)
 {
     bool sent = false;
     if (is_running())
     {
         if (data != nullptr && size > 0)
         {
-            std::size_t count;
-            if (!is_big_endian())
+            networking::framer::envelope envelope;
+            if (!framing_->wrap(size, envelope))
             {
-                reverse_byte_order((unsigned char* const) data, size);
-                count = htonl(size);
+                last_error_ = networking::error::TRANSFER_ERROR;
+                make_log(last_error_, "message of " + std::to_string(size) + " B does not fit the framing");
+                return false;
             }
-            else { count = size; }
 
-            lock_.lock();
-            if (send(sock, &count, sizeof(count), MSG_NOSIGNAL) < 0)
+            // Only connections with a state are written to, as a bare descriptor may already belong
+            // to another connection.
+            const std::shared_ptr<networking::connection_state> state = state_of(sock);
+            if (state == nullptr)
             {
                 last_error_ = networking::error::TRANSFER_ERROR;
-                lock_.unlock();
-                const char* message = make_log(last_error_, strerror(errno));
-                throw networking::networking_error(message);
+                make_log(last_error_, "socket " + std::to_string(sock) + " is not connected");
+                return false;
             }
 
-            if (send(sock, data, size, MSG_NOSIGNAL) < 0)
+            const bool is_encoded = (is_netbase_order && !is_big_endian() && framing_->is_payload_encoded());
+            if (is_encoded) {
+                reverse_byte_order((unsigned char* const) data, size);
+            }
+
+            const unsigned char* payload = static_cast<const unsigned char*>(data);
+            std::size_t payload_size = size;
+            compress(envelope, payload, payload_size);
+
+            networking::connection_metrics* const client_metrics = &state->metrics_;
+            const std::size_t threshold = batch_threshold_;
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+            // Writes to one connection are serialized, so a direct frame never overtakes, or lands
+            // in the middle of, batched ones.
+            std::unique_lock<std::recursive_mutex> write_lock(state->write_lock_);
+
+            if (state->is_closed_) {
+                sent = false;
+            }
+            else if (is_send_queued(sock))
             {
+                // A blocking write now would overtake, or split, frames still waiting in the queue.
                 last_error_ = networking::error::TRANSFER_ERROR;
-                lock_.unlock();
-                const char* message = make_log(last_error_, strerror(errno));
-                throw networking::networking_error(message);
+                make_log(last_error_, "socket " + std::to_string(sock) + " still has queued frames");
+                sent = false;
             }
+            else if (threshold > 0)
+            {
+                std::vector<unsigned char>& buffer = state->write_buffer_;
+                buffer.insert(buffer.end(), envelope.header_, envelope.header_ + envelope.header_size_);
+                buffer.insert(buffer.end(), payload, payload + payload_size);
+                buffer.insert(buffer.end(), envelope.trailer_, envelope.trailer_ + envelope.trailer_size_);
 
-            lock_.unlock();
+                sent = (buffer.size() < threshold || flush(sock, *state));
+            }
+            else
+            {
+                iovec parts[3];
+                parts[0].iov_base = envelope.header_;
+                parts[0].iov_len = envelope.header_size_;
+                parts[1].iov_base = const_cast<unsigned char*>(payload);
+                parts[1].iov_len = payload_size;
+                parts[2].iov_base = envelope.trailer_;
+                parts[2].iov_len = envelope.trailer_size_;
 
-            if (!is_big_endian()) {
-                reverse_byte_order((unsigned char* const) data, size);
+                sent = (flush(sock, *state) && send_parts(sock, parts, (envelope.trailer_size_ > 0) ? 3 : 2, client_metrics));
             }
 
-            make_log(networking::netbase::log::DATA_TRANSMITTED_LOG, "TX: " + std::to_string(size));
+            write_lock.unlock();
 
-            sent = true;
+            if (is_encoded) {
+                reverse_byte_order((unsigned char* const) data, size);
+            }
+
+            if (sent)
+            {
+                metrics_.record_transfer(size, elapsed_ns(start));
+                if (client_metrics != nullptr) { client_metrics->record_transfer(size); }
+                make_log(networking::netbase::log::DATA_TRANSMITTED_LOG, "TX: " + std::to_string(size));
+            }
         }
     }
 
@@ -114,21 +225,234 @@ bool networking::tcp::transfer(const networking::socket_t& sock, void* const dat
 }
 
 
-void networking::tcp::receive_byte_count(const networking::socket_t& sock, std::size_t& count)
+bool networking::tcp::flush(const networking::socket_t& sock)
 {
-    if (is_running())
+    const std::shared_ptr<networking::connection_state> state = state_of(sock);
+    return (state == nullptr || flush(sock, *state));
+}
+
+
+// Takes the state the caller already holds, so a descriptor reused since then never gets
+// another connection's buffer.
+bool networking::tcp::flush(const networking::socket_t& sock, networking::connection_state& state)
+{
+    std::lock_guard<std::recursive_mutex> write_lock(state.write_lock_);
+    std::vector<unsigned char>& buffer = state.write_buffer_;
+    if (!is_running() || state.is_closed_ || buffer.empty()) {
+        return true;
+    }
+
+    iovec parts[1];
+    parts[0].iov_base = buffer.data();
+    parts[0].iov_len = buffer.size();
+
+    // Batched frames are dropped on failure as well: a partial write leaves the stream unusable.
+    const bool sent = send_parts(sock, parts, 1, &state.metrics_);
+    buffer.clear();
+    return sent;
+}
+
+
+// Sends every part, returning false when the deadline expired. Callers hold the connection's
+// write_lock_, so frames from different threads never interleave, while lock_ stays free and a
+// peer that stops reading only stalls its own connection. The deadline starts once the write
+// lock is taken, so time spent behind other writers on the same connection does not count.
+bool networking::tcp::send_parts(const networking::socket_t& sock, iovec* const parts, const std::size_t& count, 
+    networking::connection_metrics* const client_metrics)
+{
+    msghdr frame = {0};
+    frame.msg_iov = parts;
+    frame.msg_iovlen = count;
+
+    const networking::timer_wheel::timer_id deadline = arm_deadline(sock);
+
+    while (frame.msg_iovlen > 0)
     {
-        lock_.lock();
-        if (recv(sock, &count, sizeof(count), MSG_WAITALL) < 0)
+        const ssize_t result = sendmsg(sock, &frame, MSG_NOSIGNAL);
+        if (result < 0)
         {
-            last_error_ = networking::error::RECEIVE_ERROR;
-            lock_.unlock();
-            const char* message = make_log(last_error_, strerror(errno));
+            const int error = errno;
+            if (is_deadline_expired(deadline))
+            {
+                deadline_expired(sock, client_metrics);
+                return false;
+            }
+
+            last_error_ = networking::error::TRANSFER_ERROR;
+            connection_lost(sock);
+            if (client_metrics != nullptr) { client_metrics->record_error(last_error_); }
+            const char* message = make_log(last_error_, strerror(error));
             throw networking::networking_error(message);
         }
-        lock_.unlock();
 
-        if (!is_big_endian()) { count = ntohl(count); }
+        std::size_t sent = static_cast<std::size_t>(result);
+        while (frame.msg_iovlen > 0 && sent >= frame.msg_iov->iov_len)
+        {
+            sent -= frame.msg_iov->iov_len;
+            ++frame.msg_iov;
+            --frame.msg_iovlen;
+        }
+
+        if (frame.msg_iovlen > 0)
+        {
+            frame.msg_iov->iov_base = static_cast<unsigned char*>(frame.msg_iov->iov_base) + sent;
+            frame.msg_iov->iov_len -= sent;
+        }
+    }
+
+    // A deadline that fired right after the last byte has already shut the socket down, so the
+    // write is reported as timed out all the same.
+    if (is_deadline_expired(deadline))
+    {
+        deadline_expired(sock, client_metrics);
+        return false;
+    }
+
+    return true;
+}
+
+
+// Frames are served from the connection's framer, which one recv fills with as much as the
+// kernel has, so back-to-back messages do not each cost a syscall.
+void networking::tcp::receive_byte_count(const networking::socket_t& sock, std::size_t& count)
+{
+    count = 0;
+    const std::shared_ptr<networking::connection_state> state = state_of(sock);
+
+    if (is_running() && state != nullptr && state->framer_ != nullptr)
+    {
+        std::lock_guard<std::recursive_mutex> read_lock(state->read_lock_);
+        if (state->is_closed_) {
+            return;
+        }
+
+        networking::framer* const parser = state->framer_.get();
+        networking::connection_metrics* const client_metrics = &state->metrics_;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        unsigned char* payload = nullptr;
+        std::size_t payload_size = 0;
+        networking::framer::status result;
+
+        // Latency counts from the moment data is at hand, not from when the wait for the peer began.
+        while ((result = parser->front(payload, payload_size)) != networking::framer::status::MALFORMED)
+        {
+            if (result == networking::framer::status::INCOMPLETE) 
+            {
+                if (!read_some(sock, *state)) { return; }
+                start = std::chrono::steady_clock::now();
+            }
+            else if (payload_size == 0) { parser->pop(); }
+            else { break; }
+        }
+
+        const std::uint8_t codec = parser->front_codec();
+        if (result != networking::framer::status::MALFORMED && codec != 0) {
+            payload_size = original_size(codec, payload, payload_size, *parser);
+        }
+
+        if (result == networking::framer::status::MALFORMED || payload_size == 0)
+        {
+            malformed_frame(sock, client_metrics);
+            return;
+        }
+
+        metrics_.record_receive(payload_size, elapsed_ns(start));
+        if (client_metrics != nullptr) { client_metrics->record_receive(payload_size); }
+
+        count = payload_size;
+    }
+}
+
+
+std::size_t networking::tcp::receive_frames(const networking::socket_t& sock, const networking::framer::frame_callback& on_frame, 
+    const bool& is_netbase_order)
+{
+    std::size_t frames = 0;
+    const std::shared_ptr<networking::connection_state> state = state_of(sock);
+
+    if (is_running() && state != nullptr && state->framer_ != nullptr)
+    {
+        std::lock_guard<std::recursive_mutex> read_lock(state->read_lock_);
+        if (state->is_closed_) {
+            return 0;
+        }
+
+        networking::framer* const parser = state->framer_.get();
+        networking::connection_metrics* const client_metrics = &state->metrics_;
+
+        unsigned char* payload = nullptr;
+        std::size_t payload_size = 0;
+        if (parser->front(payload, payload_size) == networking::framer::status::INCOMPLETE && 
+            !read_some(sock, *state))
+        {
+            return 0;
+        }
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        const bool is_encoded = (is_netbase_order && !is_big_endian() && parser->is_payload_encoded());
+        networking::framer::status result;
+
+        while ((result = parser->front(payload, payload_size)) == networking::framer::status::COMPLETE)
+        {
+            const std::uint8_t codec = parser->front_codec();
+            parser->pop();
+
+            if (codec != 0)
+            {
+                const std::size_t original = original_size(codec, payload, payload_size, *parser);
+                std::vector<unsigned char>& scratch = decompress_scratch();
+                scratch.resize(original);
+
+                if (original == 0 || !decompress(codec, payload, payload_size, scratch.data(), original))
+                {
+                    result = networking::framer::status::MALFORMED;
+                    break;
+                }
+
+                payload = scratch.data();
+                payload_size = original;
+            }
+
+            metrics_.record_receive(payload_size, elapsed_ns(start));
+            if (client_metrics != nullptr) { client_metrics->record_receive(payload_size); }
+
+            if (is_encoded) {
+                reverse_byte_order(payload, payload_size);
+            }
+            make_log(networking::netbase::log::DATA_RECEIVED_LOG, "RX: " + std::to_string(payload_size));
+
+            frames += 1;
+            if (on_frame) { on_frame(payload, payload_size); }
+        }
+
+        if (result == networking::framer::status::MALFORMED) { malformed_frame(sock, client_metrics); }
+    }
+
+    return frames;
+}
+
+
+void networking::tcp::framing(const networking::framer& prototype)
+{
+    if (!is_running()) {
+        framing_ = prototype.clone();
+    }
+}
+
+
+void networking::tcp::compression(const std::shared_ptr<const networking::codec>& codec, const std::size_t& min_size)
+{
+    if (!is_running())
+    {
+        if (codec != nullptr && (codec->id() == 0 || codec->id() >= networking::frame_header::CODECS_COUNT)) {
+            throw networking::networking_error("Codec id must be 1 to 15");
+        }
+
+        compression_ = codec;
+        compression_threshold_ = min_size;
+        if (codec != nullptr) { codecs_[codec->id()] = codec; }
     }
 }
 
@@ -137,6 +461,8 @@ bool networking::tcp::is_data_to_receive(const networking::socket_t& sock) const
 {
     if (sock != networking::socket_t::NONE && is_running())
     {
+        if (is_frame_buffered(sock)) { return true; }
+
         std::shared_lock<std::shared_mutex> lock(lock_);
         int buffer = 0;
         const int result = recv(sock, &buffer, sizeof(buffer), MSG_PEEK | MSG_DONTWAIT);
@@ -144,4 +470,174 @@ bool networking::tcp::is_data_to_receive(const networking::socket_t& sock) const
     }
 
     return false;
+}
+
+
+std::shared_ptr<networking::connection_state> networking::tcp::state_of(const networking::socket_t& sock) const
+{
+    return nullptr;
+}
+
+
+bool networking::tcp::is_send_queued(const networking::socket_t& sock) const
+{
+    return false;
+}
+
+
+bool networking::tcp::is_frame_buffered(const networking::socket_t& sock) const
+{
+    const std::shared_ptr<networking::connection_state> state = state_of(sock);
+    if (state == nullptr || state->framer_ == nullptr) {
+        return false;
+    }
+
+    // A reader busy with the framer is consuming what it holds, so only the socket is worth asking.
+    std::unique_lock<std::recursive_mutex> read_lock(state->read_lock_, std::try_to_lock);
+    return (read_lock.owns_lock() && state->framer_->has_complete_frame());
+}
+
+
+// Reads once into the framer, returning false when nothing arrived because the peer closed the
+// connection or the deadline expired. Batched writes go out first, as the peer may be waiting
+// for them before it answers. Callers hold the connection's read_lock_; lock_ is not taken, so
+// a peer that stays silent does not stall the other connections.
+bool networking::tcp::read_some(const networking::socket_t& sock, networking::connection_state& state)
+{
+    if (!flush(sock, state)) {
+        return false;
+    }
+
+    networking::connection_metrics* const client_metrics = &state.metrics_;
+    unsigned char* const buffer = state.framer_->prepare(READ_SIZE);
+
+    const networking::timer_wheel::timer_id deadline = arm_deadline(sock);
+    const ssize_t result = recv(sock, buffer, READ_SIZE, 0);
+    const int error = errno;
+
+    if (is_deadline_expired(deadline))
+    {
+        deadline_expired(sock, client_metrics);
+        return false;
+    }
+    else if (result < 0)
+    {
+        last_error_ = networking::error::RECEIVE_ERROR;
+        connection_lost(sock);
+        if (client_metrics != nullptr) { client_metrics->record_error(last_error_); }
+        const char* message = make_log(last_error_, strerror(error));
+        throw networking::networking_error(message);
+    }
+
+    if (options_.quick_ack_.value_or(false))
+    {
+        const int option = 1;
+        setsockopt(sock, IPPROTO_TCP, TCP_QUICKACK, &option, sizeof(option));
+    }
+
+    if (result == 0)
+    {
+        connection_lost(sock);
+        return false;
+    }
+
+    state.framer_->commit(static_cast<std::size_t>(result));
+    return true;
+}
+
+
+void networking::tcp::malformed_frame(const networking::socket_t& sock, networking::connection_metrics* const client_metrics)
+{
+    last_error_ = networking::error::RECEIVE_ERROR;
+    connection_lost(sock);
+    if (client_metrics != nullptr) { client_metrics->record_error(last_error_); }
+    make_log(last_error_, "malformed frame on socket " + std::to_string(sock));
+}
+
+
+// Replaces an encoded payload with its compressed form, prefixed by the original size, when
+// compression is on, the message reaches the threshold and the result is actually smaller.
+bool networking::tcp::compress(networking::framer::envelope& envelope, const unsigned char*& payload, std::size_t& size) const
+{
+    if (compression_ == nullptr || size < compression_threshold_) {
+        return false;
+    }
+
+    std::vector<unsigned char>& scratch = compress_scratch();
+    scratch.resize(networking::frame_header::MAX_SIZE + compression_->bound(size));
+
+    const std::size_t header_size = networking::frame_header::encode(size, scratch.data());
+    const std::size_t compressed_size = compression_->compress(payload, size, 
+        scratch.data() + header_size, scratch.size() - header_size);
+
+    if (compressed_size == 0 || header_size + compressed_size >= size || 
+        !framing_->wrap_compressed(header_size + compressed_size, compression_->id(), envelope))
+    {
+        return false;
+    }
+
+    payload = scratch.data();
+    size = header_size + compressed_size;
+    return true;
+}
+
+
+// Size of the message a compressed payload inflates to, or 0 when the frame cannot be trusted.
+std::size_t networking::tcp::original_size(const std::uint8_t& codec, const unsigned char* const payload, const std::size_t& size, 
+    const networking::framer& parser) const
+{
+    if (codec >= networking::frame_header::CODECS_COUNT || codecs_[codec] == nullptr || size == 0) {
+        return 0;
+    }
+
+    const std::size_t header_size = networking::frame_header::size(payload[0]);
+    if (header_size == 0 || header_size > size) {
+        return 0;
+    }
+
+    const std::uint64_t original = networking::frame_header::decode(payload);
+    return (original <= parser.max_frame_size()) ? static_cast<std::size_t>(original) : 0;
+}
+
+
+bool networking::tcp::decompress(const std::uint8_t& codec, const unsigned char* const payload, const std::size_t& size, 
+    unsigned char* const destination, const std::size_t& original) const
+{
+    const std::size_t header_size = networking::frame_header::size(payload[0]);
+    return codecs_[codec]->decompress(payload + header_size, size - header_size, destination, original);
+}
+
+
+void networking::tcp::connection_lost(const networking::socket_t& sock)
+{
+
+}
+
+
+networking::timer_wheel::timer_id networking::tcp::arm_deadline(const networking::socket_t& sock) const
+{
+    if (operation_timeout_.count() > 0) 
+    {
+        const int deadline_sock = sock;
+        return networking::timer_wheel::shared().schedule(operation_timeout_, [deadline_sock]() { 
+            shutdown(deadline_sock, SHUT_RDWR); 
+        });
+    }
+
+    return networking::timer_wheel::NONE;
+}
+
+
+bool networking::tcp::is_deadline_expired(const networking::timer_wheel::timer_id& deadline) const
+{
+    return (deadline != networking::timer_wheel::NONE && !networking::timer_wheel::shared().cancel(deadline));
+}
+
+
+void networking::tcp::deadline_expired(const networking::socket_t& sock, networking::connection_metrics* const client_metrics)
+{
+    last_error_ = networking::error::TIMEOUT_ERROR;
+    connection_lost(sock);
+    if (client_metrics != nullptr) { client_metrics->record_error(last_error_); }
+    make_log(last_error_, "socket " + std::to_string(sock));
 }
\ No newline at end of file
@@ -1,6 +1,19 @@
 #ifndef __NETWORKING_TCP_HPP__
 #define __NETWORKING_TCP_HPP__
 #include "netbase.hpp"
+#include "timer_wheel.hpp"
+#include "framer.hpp"
+#include "frame_header.hpp"
+#include "codec.hpp"
+#include "message.hpp"
+#include "connection_state.hpp"
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/uio.h>
 
 
 namespace networking
@@ -10,7 +23,8 @@ namespace networking
         public:
             tcp() = default;
             tcp(const std::string& ip_address, const std::uint16_t& port, 
-                const networking::communication& communicaton_type, const std::string& log_file_path = "");
+                const networking::communication& communicaton_type, const std::string& log_file_path = "", 
+                const networking::socket_options& options = networking::socket_options());
             tcp(const tcp& obj) = delete;
             tcp(tcp&& obj) = delete;
             virtual ~tcp() = 0;
@@ -20,14 +34,122 @@ namespace networking
 
             virtual void start() override;
             virtual bool is_data_to_receive(const networking::socket_t& sock) const override;
+            // Every connection parses with its own clone of the prototype, which can only be
+            // replaced while the endpoint is stopped.
+            std::shared_ptr<const networking::framer> framing() const;
+            void framing(const networking::framer& prototype);
+            // With a non-zero threshold transfer() only appends to a per-connection buffer, which
+            // is sent once it reaches the threshold, on flush(), before the connection blocks
+            // on a read, when a tcp_server handler returns and when the connection is ended.
+            std::size_t batching() const;
+            void batching(const std::size_t& threshold);
+            // Messages of at least min_size bytes are sent compressed when that makes them smaller.
+            // The codec is also registered for incoming frames, so a peer that only receives
+            // compressed data sets a min_size no message reaches. Frames of codecs that were
+            // never registered are malformed. Only framings with a header carry the flag.
+            std::shared_ptr<const networking::codec> compression() const;
+            std::size_t compression_threshold() const;
+            void compression(const std::shared_ptr<const networking::codec>& codec, const std::size_t& min_size = 1024);
 
 
         protected:
             bool receive(const networking::socket_t& sock, void* const data, const std::size_t& size) override;
             bool transfer(const networking::socket_t& sock, void* const data, const std::size_t& size) override;
+            bool transfer_frame(const networking::socket_t& sock, void* const data, const std::size_t& size, 
+                const bool& is_netbase_order);
+            bool flush(const networking::socket_t& sock);
+            bool flush(const networking::socket_t& sock, networking::connection_state& state);
             void receive_byte_count(const networking::socket_t& sock, std::size_t& count) override;
+            std::size_t receive_frames(const networking::socket_t& sock, const networking::framer::frame_callback& on_frame, 
+                const bool& is_netbase_order = true);
+            virtual std::shared_ptr<networking::connection_state> state_of(const networking::socket_t& sock) const;
+            virtual bool is_send_queued(const networking::socket_t& sock) const;
+            bool is_frame_buffered(const networking::socket_t& sock) const override;
+            virtual void connection_lost(const networking::socket_t& sock);
+            networking::timer_wheel::timer_id arm_deadline(const networking::socket_t& sock) const;
+            bool is_deadline_expired(const networking::timer_wheel::timer_id& deadline) const;
+            void deadline_expired(const networking::socket_t& sock, networking::connection_metrics* const client_metrics);
+            bool send_parts(const networking::socket_t& sock, iovec* const parts, const std::size_t& count, 
+                networking::connection_metrics* const client_metrics);
+            bool read_some(const networking::socket_t& sock, networking::connection_state& state);
+            void malformed_frame(const networking::socket_t& sock, networking::connection_metrics* const client_metrics);
+            bool compress(networking::framer::envelope& envelope, const unsigned char*& payload, std::size_t& size) const;
+            std::size_t original_size(const std::uint8_t& codec, const unsigned char* const payload, const std::size_t& size, 
+                const networking::framer& parser) const;
+            bool decompress(const std::uint8_t& codec, const unsigned char* const payload, const std::size_t& size, 
+                unsigned char* const destination, const std::size_t& original) const;
+
+
+            // Messages carry their own big-endian layout, so they skip the netbase byte order.
+            template<typename T>
+            bool transfer_message(const networking::socket_t& sock, const T& message)
+            {
+                std::array<unsigned char, networking::message<T>::WIRE_SIZE> buffer;
+                networking::message<T>::encode(message, buffer.data());
+                return transfer_frame(sock, buffer.data(), buffer.size(), false);
+            }
+
+            // Views point into the connection's read buffer and are only valid inside the callback;
+            // frames of the wrong size are skipped and logged.
+            template<typename T>
+            std::size_t receive_messages(const networking::socket_t& sock, 
+                const std::function<void(const networking::message_view<T>&)>& on_message)
+            {
+                std::size_t messages = 0;
+                receive_frames(sock, [this, &messages, &on_message](unsigned char* const data, const std::size_t& size) {
+                    const networking::message_view<T> view(data, size);
+                    if (!view.is_valid())
+                    {
+                        last_error_ = networking::error::RECEIVE_ERROR;
+                        make_log(last_error_, "message of " + std::to_string(size) + " B, expected " + 
+                            std::to_string(networking::message_view<T>::WIRE_SIZE) + " B");
+                        return;
+                    }
+
+                    messages += 1;
+                    if (on_message) { on_message(view); }
+                }, false);
+
+                return messages;
+            }
+
+            static constexpr std::size_t READ_SIZE = 64 * 1024;
+
+
+        protected:
+            std::shared_ptr<const networking::framer> framing_ = std::make_shared<networking::length_prefix_framer>();
+            std::atomic<std::size_t> batch_threshold_ = 0;
+            std::shared_ptr<const networking::codec> compression_;
+            std::size_t compression_threshold_ = 0;
+            std::array<std::shared_ptr<const networking::codec>, networking::frame_header::CODECS_COUNT> codecs_;
     };
 }
 
 
+inline std::shared_ptr<const networking::framer> networking::tcp::framing() const
+{
+    return framing_;
+}
+
+inline std::size_t networking::tcp::batching() const
+{
+    return batch_threshold_;
+}
+
+inline void networking::tcp::batching(const std::size_t& threshold)
+{
+    batch_threshold_ = threshold;
+}
+
+inline std::shared_ptr<const networking::codec> networking::tcp::compression() const
+{
+    return compression_;
+}
+
+inline std::size_t networking::tcp::compression_threshold() const
+{
+    return compression_threshold_;
+}
+
+
 #endif
\ No newline at end of file
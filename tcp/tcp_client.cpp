@@ -6,27 +6,54 @@
 
 
 networking::tcp_client::tcp_client(const std::string& ip_address, const std::uint16_t& port,
-    const networking::communication& communicaton_type, const std::string& log_file_path) :
-    tcp(ip_address, port, communicaton_type, log_file_path)
+    const networking::communication& communicaton_type, const std::string& log_file_path, 
+    const networking::socket_options& options) :
+    tcp(ip_address, port, communicaton_type, log_file_path, options)
 {
 
 }
 
 
+networking::tcp_client::~tcp_client()
+{
+    stop_keepalive();
+}
+
+
 void networking::tcp_client::start()
 {
     if (!is_running())
     {
+        close_connection();
+        tcp::end();
         tcp::start();
+
+        if (!apply_options(server_.socket_, SOCK_STREAM))
+        {
+            last_error_ = networking::error::SET_SOCKET_OPTIONS_ERROR;
+            const char* message = make_log(last_error_, strerror(errno));
+            close(server_.socket_);
+            server_.socket_ = networking::socket_t::NONE;
+            throw networking::networking_error(message);
+        }
         
         if (connect(server_.socket_, (sockaddr*) &server_.connection_, sizeof(server_.connection_)) == -1)
         {
             last_error_ = networking::error::CONNECT_ERROR;
             const char* message = make_log(last_error_, strerror(errno));
             close(server_.socket_);
+            server_.socket_ = networking::socket_t::NONE;
             throw networking::networking_error(message);
         }
 
+        // Operations still running on the previous connection keep its state until they return.
+        std::shared_ptr<networking::connection_state> state = std::make_shared<networking::connection_state>();
+        state->framer_ = framing_->clone();
+        lock_.lock();
+        state_ = state;
+        lock_.unlock();
+
+        connected_.store(true, std::memory_order_release);
         make_log(networking::netbase::log::CLIENT_CONNECTED_LOG);
     }
 }
@@ -34,6 +61,11 @@ void networking::tcp_client::start()
 
 void networking::tcp_client::end()
 {
+    if (is_running()) { flush(); }
+    stop_keepalive();
+    connected_.store(false, std::memory_order_release);
+    close_connection();
+
     const std::string server_info = server_.info();
     tcp::end();
     make_log(networking::netbase::log::CLIENT_DISCONNECTED_LOG, server_info);
@@ -42,26 +74,109 @@ void networking::tcp_client::end()
 
 bool networking::tcp_client::is_running() const
 {
-    std::shared_lock<std::shared_mutex> lock(lock_);
-    if (server_.socket_ != networking::socket_t::NONE)
+    return connected_.load(std::memory_order_acquire);
+}
+
+
+bool networking::tcp_client::probe()
+{
+    if (is_running())
     {
-        int buffer = 0;
-        const int result = recv(server_.socket_, &buffer, sizeof(buffer), MSG_PEEK | MSG_DONTWAIT);
-
-        if (result == 0) { return false; }
-        else if (result < 0)
-        { 
-            if (errno == EAGAIN || errno == EWOULDBLOCK) { return true; }
-            else { return false; }
-        }
-        else { return true; }
+        std::shared_lock<std::shared_mutex> lock(lock_);
+        peek_connection();
     }
 
-    return false;
+    return is_running();
+}
+
+
+void networking::tcp_client::keepalive(const std::chrono::milliseconds& interval)
+{
+    stop_keepalive();
+
+    if (interval.count() > 0)
+    {
+        // The timer wheel thread must not block, so a probe is skipped while another
+        // operation holds the socket; that operation checks the connection anyway.
+        keepalive_ = networking::timer_wheel::shared().schedule_repeating(interval, [this, interval]() {
+            std::shared_lock<std::shared_mutex> lock(lock_, std::try_to_lock);
+            if (lock.owns_lock() && is_running()) { peek_connection(); }
+            return is_running() ? interval : std::chrono::milliseconds(0);
+        });
+    }
 }
 
 
 bool networking::tcp_client::is_data_to_receive() const
 {
     return tcp::is_data_to_receive(server_.socket_);
+}
+
+
+std::size_t networking::tcp_client::receive_frames(const networking::framer::frame_callback& on_frame)
+{
+    return tcp::receive_frames(server_.socket_, on_frame);
+}
+
+
+bool networking::tcp_client::flush()
+{
+    return tcp::flush(server_.socket_);
+}
+
+
+bool networking::tcp_client::wait_readable(const std::chrono::milliseconds& timeout)
+{
+    return tcp::wait_readable(server_.socket_, timeout);
+}
+
+
+bool networking::tcp_client::wait_writable(const std::chrono::milliseconds& timeout)
+{
+    return tcp::wait_writable(server_.socket_, timeout);
+}
+
+
+void networking::tcp_client::connection_lost(const networking::socket_t& sock)
+{
+    connected_.store(false, std::memory_order_release);
+}
+
+
+std::shared_ptr<networking::connection_state> networking::tcp_client::state_of(const networking::socket_t& sock) const
+{
+    std::shared_lock<std::shared_mutex> lock(lock_);
+    return (sock == server_.socket_) ? state_ : nullptr;
+}
+
+
+void networking::tcp_client::peek_connection()
+{
+    int buffer = 0;
+    const int result = recv(server_.socket_, &buffer, sizeof(buffer), MSG_PEEK | MSG_DONTWAIT);
+
+    if (result == 0 || (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        connected_.store(false, std::memory_order_release);
+    }
+}
+
+
+// Shuts the socket down, which wakes operations blocked on it, and waits for them to return, so
+// the descriptor is never used once it is closed.
+void networking::tcp_client::close_connection()
+{
+    const std::shared_ptr<networking::connection_state> state = state_of(server_.socket_);
+    if (state != nullptr && server_.socket_ != networking::socket_t::NONE)
+    {
+        shutdown(server_.socket_, SHUT_RDWR);
+        std::lock_guard<std::recursive_mutex> read_lock(state->read_lock_);
+        std::lock_guard<std::recursive_mutex> write_lock(state->write_lock_);
+        state->is_closed_ = true;
+    }
+}
+
+
+void networking::tcp_client::stop_keepalive()
+{
+    networking::timer_wheel::shared().cancel(keepalive_.exchange(networking::timer_wheel::NONE));
 }
\ No newline at end of file
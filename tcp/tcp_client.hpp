@@ -5,6 +5,9 @@
 #include <cerrno>
 #include <cstring>
 #include <vector>
+#include <atomic>
+#include <chrono>
+#include <memory>
 
 
 namespace networking
@@ -14,10 +17,11 @@ namespace networking
         public:
             tcp_client() = default;
             tcp_client(const std::string& ip_address, const std::uint16_t& port, 
-                const networking::communication& communicaton_type, const std::string& log_file_path);
+                const networking::communication& communicaton_type, const std::string& log_file_path, 
+                const networking::socket_options& options = networking::socket_options());
             tcp_client(const tcp_client& obj) = delete;
             tcp_client(tcp_client&& obj) = delete;
-            ~tcp_client() = default;
+            ~tcp_client();
 
             tcp_client& operator=(const tcp_client& obj) = delete;
             tcp_client& operator=(tcp_client&& obj) = delete;
@@ -25,7 +29,13 @@ namespace networking
             void start() override;
             void end() override;
             bool is_running() const override;
+            bool probe();
+            void keepalive(const std::chrono::milliseconds& interval);
             bool is_data_to_receive() const;
+            std::size_t receive_frames(const networking::framer::frame_callback& on_frame);
+            bool flush();
+            bool wait_readable(const std::chrono::milliseconds& timeout = std::chrono::milliseconds(-1));
+            bool wait_writable(const std::chrono::milliseconds& timeout = std::chrono::milliseconds(-1));
 
             template<typename T>
             bool transfer(T* const data, const std::size_t& count)
@@ -33,13 +43,28 @@ namespace networking
                 return tcp::transfer(server_.socket_, data, (sizeof(T) * count));
             }
 
+            template<typename T>
+            bool transfer_message(const T& message)
+            {
+                return tcp::transfer_message(server_.socket_, message);
+            }
+
+            template<typename T>
+            std::size_t receive_messages(const std::function<void(const networking::message_view<T>&)>& on_message)
+            {
+                return tcp::receive_messages<T>(server_.socket_, on_message);
+            }
+
             template<typename T, typename RT>
             RT receive()
             {
                 std::size_t count = 0;
                 receive_byte_count(server_.socket_, count);
 
-                if (count > 0)
+                if (count % sizeof(T) != 0) {
+                    reject_message(server_.socket_, count, sizeof(T));
+                }
+                else if (count > 0)
                 {
                     RT buffer(count / sizeof(T));
                     if (tcp::receive(server_.socket_, buffer.data(), count))
@@ -50,6 +75,21 @@ namespace networking
 
                 return RT();
             }
+
+
+        protected:
+            void connection_lost(const networking::socket_t& sock) override;
+            std::shared_ptr<networking::connection_state> state_of(const networking::socket_t& sock) const override;
+
+
+        private:
+            void peek_connection();
+            void close_connection();
+            void stop_keepalive();
+
+            std::atomic<bool> connected_ = false;
+            std::atomic<networking::timer_wheel::timer_id> keepalive_ = networking::timer_wheel::NONE;
+            std::shared_ptr<networking::connection_state> state_;
     };
 }
 
@@ -2,14 +2,21 @@
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <chrono>
 #include <mutex>
+#include <sstream>
 
 
 networking::tcp_server::tcp_server(const std::string& ip_address, const std::uint16_t& port, 
-    const networking::communication& communication_type, const std::uint16_t& max_connections, const std::string& log_file_path) :
-    tcp(ip_address, port, communication_type, log_file_path), max_connections_(max_connections), threads_(max_connections)
+    const networking::communication& communication_type, const std::uint16_t& max_connections, const std::string& log_file_path, 
+    const networking::socket_options& options) :
+    tcp(ip_address, port, communication_type, log_file_path, options), max_connections_(max_connections), 
+    threads_(initial_threads(max_connections), max_connections)
 {
-
+    sends_.on_error([this](const networking::socket_t& sock, const int& error) { send_failed(sock, error); });
 }
 
 
@@ -24,13 +31,13 @@ void networking::tcp_server::reset()
 
 void networking::tcp_server::reload(const std::string& ip_address, const std::uint16_t& port, 
     const networking::communication& communication_type, 
-    const std::uint16_t& max_connections, const std::string& log_file_path)
+    const std::uint16_t& max_connections, const std::string& log_file_path, const networking::socket_options& options)
 {
     end();
 
-    tcp::reload(ip_address, port, communication_type, log_file_path);
+    tcp::reload(ip_address, port, communication_type, log_file_path, options);
     max_connections_ = max_connections;
-    threads_.threads_count(max_connections_);
+    threads_.limits(initial_threads(max_connections_), max_connections_);
 
     start();
 }
@@ -41,32 +48,28 @@ void networking::tcp_server::start()
     if (!is_running())
     {
         tcp::start();
+        open_listener(server_.socket_);
 
-        const int option = 1;
-        if (setsockopt(server_.socket_, SOL_SOCKET, SO_REUSEADDR, &option, sizeof(option)) == -1)
+        for (std::uint16_t i = 1; i < listeners_count_; ++i)
         {
-            last_error_ = networking::error::SET_SOCKET_OPTIONS_ERROR;
-            const char* message = make_log(last_error_, strerror(errno));
-            close(server_.socket_);
-            server_.socket_ = networking::socket_t::NONE;
-            throw networking::networking_error(message);
-        }
+            networking::socket_t listener = socket(static_cast<int>(communication_type_), SOCK_STREAM, 0);
+            if (listener == networking::socket_t::NONE)
+            {
+                last_error_ = networking::error::OPEN_SOCKET_ERROR;
+                const char* message = make_log(last_error_, strerror(errno));
+                close_listeners();
+                throw networking::networking_error(message);
+            }
 
-        if (bind(server_.socket_, (const sockaddr*) &server_.connection_, sizeof(server_.connection_)) == -1)
-        {
-            last_error_ = networking::error::BIND_TO_SOCKET_ERROR;
-            const char* message = make_log(last_error_, strerror(errno)); 
-            close(server_.socket_);
-            server_.socket_ = networking::socket_t::NONE;
-            throw networking::networking_error(message);
+            open_listener(listener);
+            listeners_.push_back(listener);
         }
 
-        if (listen(server_.socket_, max_connections_) == -1)
+        if (!sends_.start())
         {
-            last_error_ = networking::error::LISTEN_ON_SOCKET_ERROR;
-            const char* const message = make_log(last_error_, strerror(errno));
-            close(server_.socket_);
-            server_.socket_ = networking::socket_t::NONE;
+            last_error_ = networking::error::OPEN_SOCKET_ERROR;
+            const char* message = make_log(last_error_, strerror(errno));
+            close_listeners();
             throw networking::networking_error(message);
         }
 
@@ -81,63 +84,101 @@ void networking::tcp_server::end()
 {
     if (is_running())
     {
+        stop_serving();
+
         const std::string server_info = server_.info();
         tcp::end();
 
         lock_.lock();
-        for (const auto& client : clients_)
-        {
-            if (close(client.socket_) == -1)
-            {
-                last_error_ = networking::error::CLOSE_SOCKET_ERROR;
-                lock_.unlock();
-                const char* message = make_log(last_error_);
-                throw networking::networking_error(message);
-            }
-        }
+        for (const auto& listener : listeners_) { close(listener); }
+        listeners_.clear();
         lock_.unlock();
 
+        // Shutting the clients down wakes handlers blocked on them, and a shared lock is enough for
+        // that. Descriptors are only closed once the handlers are gone and nothing else holds a
+        // connection's locks, so no operation or deadline ever reaches a reused descriptor.
+        std::vector<std::shared_ptr<networking::connection_state>> states;
+        lock_.lock_shared();
+        states.reserve(clients_.size());
+        clients_.for_each([this, &states](const networking::connection_table::entry& client) {
+            networking::timer_wheel::shared().cancel(client.idle_timer_);
+            sends_.close(client.socket_);
+            client.state_->is_closed_ = true;
+            shutdown(client.socket_, SHUT_RDWR);
+            states.push_back(client.state_);
+        });
+        lock_.unlock_shared();
+
         threads_.wait();
         threads_.stop();
+        sends_.stop();
+
+        for (const auto& state : states)
+        {
+            std::lock_guard<std::recursive_mutex> read_lock(state->read_lock_);
+            std::lock_guard<std::recursive_mutex> write_lock(state->write_lock_);
+        }
 
         lock_.lock();
+        bool is_closed = true;
+        clients_.for_each([&is_closed](const networking::connection_table::entry& client) {
+            if (close(client.socket_) == -1) { is_closed = false; }
+        });
         last_connections_.clear();
         clients_.clear();
         lock_.unlock();
 
+        if (!is_closed)
+        {
+            last_error_ = networking::error::CLOSE_SOCKET_ERROR;
+            const char* message = make_log(last_error_);
+            throw networking::networking_error(message);
+        }
+
         make_log(networking::netbase::log::SERVER_STOPPED_LOG, server_info);
     }
 }
 
 
+// Batched frames go out first. The socket is then shut down, which wakes operations blocked on
+// it, and once they return the state is closed, so the descriptor is never used after close().
 void networking::tcp_server::end(const networking::socket_t& sock)
 {
-    if (is_running() && sock != networking::socket_t::NONE)
+    const std::shared_ptr<networking::connection_state> state = 
+        (sock != networking::socket_t::NONE) ? state_of(sock) : nullptr;
+
+    if (is_running() && state != nullptr)
     {
+        try { tcp::flush(sock, *state); }
+        catch (const networking::networking_error&) {}
+
         lock_.lock_shared();
-        auto client = clients_.begin();
-        
-        for (; client != clients_.end(); client++)
-        {
-            if ((*client).socket_ == sock) { break; }
-        }
+        const networking::connection_table::entry* client = clients_.find(sock);
+        if (client != nullptr && client->state_ == state) { shutdown(sock, SHUT_RDWR); }
         lock_.unlock_shared();
 
-        lock_.lock();  
-        if (client != clients_.end())
+        std::lock_guard<std::recursive_mutex> read_lock(state->read_lock_);
+        std::lock_guard<std::recursive_mutex> write_lock(state->write_lock_);
+        state->is_closed_ = true;
+
+        lock_.lock();
+        client = clients_.find(sock);
+        if (client != nullptr && client->state_ == state)
         {
+            networking::timer_wheel::shared().cancel(client->idle_timer_);
+            const std::string client_info_str = client->info();
+            clients_.erase(sock);
+            sends_.close(sock);
+            metrics_.record_disconnect();
+
             if (close(sock) == -1)
             {
-                clients_.erase(client);
                 last_error_ = networking::error::CLOSE_SOCKET_ERROR;
                 lock_.unlock();
                 const char* message = make_log(last_error_);        
                 throw networking::networking_error(message);
             }
 
-            const std::string client_info_str = client->info();
-            clients_.erase(client);
-
             lock_.unlock();
             make_log(networking::netbase::log::CLIENT_DISCONNECTED_LOG, client_info_str);
             return;
@@ -150,33 +191,89 @@ void networking::tcp_server::end(const networking::socket_t& sock)
 
 networking::socket_t networking::tcp_server::handle(const std::function<void()>& task)
 {
-    if (is_running() && clients_.size() < max_connections_)
+    return accept_client(server_.socket_, [this, &task](const networking::connection_ref& client) {
+        queue_connection(client, task);
+    });
+}
+
+
+networking::socket_t networking::tcp_server::handle(const std::function<void(networking::connection_ref)>& task)
+{
+    return accept_client(server_.socket_, [this, &task](const networking::connection_ref& client) {
+        const std::shared_ptr<networking::connection_state> state = state_of(client.socket_);
+        threads_.add_task([this, task, client, state]() { 
+            task(client); 
+            handler_finished(client.socket_, state);
+        }, client.cpu_);
+    });
+}
+
+
+void networking::tcp_server::serve(const std::function<void()>& task)
+{
+    start_acceptors([this, task](const networking::connection_ref& client) {
+        queue_connection(client, task);
+    });
+}
+
+
+void networking::tcp_server::serve(const std::function<void(networking::connection_ref)>& task)
+{
+    start_acceptors([this, task](const networking::connection_ref& client) {
+        const std::shared_ptr<networking::connection_state> state = state_of(client.socket_);
+        threads_.add_task([this, task, client, state]() { 
+            task(client); 
+            handler_finished(client.socket_, state);
+        }, client.cpu_);
+    });
+}
+
+
+void networking::tcp_server::start_acceptors(const std::function<void(const networking::connection_ref&)>& dispatch)
+{
+    if (is_running() && acceptors_.empty())
     {
-        tcp_server::connection client;
-        socklen_t client_size = sizeof(client.connection_);
+        std::vector<networking::socket_t> listeners(1, server_.socket_);
+        listeners.insert(listeners.end(), listeners_.begin(), listeners_.end());
+
+        // Acceptors are placed like the workers, so they stay within the CPUs the policy allows;
+        // without a policy they keep the process affinity.
+        const std::vector<std::vector<int>> sets = threads_.placement_sets();
+        serving_ = true;
 
-        if ((client.socket_ = accept(server_.socket_, (sockaddr*) &client.connection_, &client_size)) == -1)
+        for (std::size_t i = 0; i < listeners.size(); ++i)
         {
-            last_error_ = networking::error::ACCEPT_CONNECTION_ERROR;
-            const char* message = make_log(last_error_, strerror(errno));
-            throw networking::networking_error(message);
+            acceptors_.emplace_back(&tcp_server::accept_loop, this, listeners[i], dispatch);
+
+            if (!sets.empty())
+            {
+                cpu_set_t cpus;
+                CPU_ZERO(&cpus);
+                for (const auto& cpu : sets[i % sets.size()]) { CPU_SET(cpu, &cpus); }
+                pthread_setaffinity_np(acceptors_.back().native_handle(), sizeof(cpus), &cpus);
+            }
         }
+    }
+}
 
-        lock_.lock();
 
-        clients_.push_back(std::move(client));
-        threads_.add_task(task);
-        last_connections_.push_back(clients_.back().socket_);
-        client.socket_ = clients_.back().socket_;
+void networking::tcp_server::threads_limits(const std::uint16_t& min_threads, const std::uint16_t& max_threads)
+{
+    threads_.limits(min_threads, max_threads);
+}
+
 
-        lock_.unlock();
+void networking::tcp_server::placement(const thread_pool::placement_policy& policy)
+{
+    threads_.placement(policy);
+}
 
-        make_log(networking::netbase::log::CLIENT_CONNECTED_LOG, clients_.back().info());
 
-        return client.socket_;
+void networking::tcp_server::listeners_count(const std::uint16_t& listeners_count)
+{
+    if (!is_running()) {
+        listeners_count_ = std::max<std::uint16_t>(1, listeners_count);
     }
-
-    return networking::socket_t::NONE;
 }
 
 
@@ -201,6 +298,8 @@ bool networking::tcp_server::is_connected(const networking::socket_t& sock) cons
 {
     if (is_running() && sock != networking::socket_t::NONE)
     {
+        if (is_frame_buffered(sock)) { return true; }
+
         std::shared_lock<std::shared_mutex> lock(lock_);
         int buffer = 0;
         const int result = recv(sock, &buffer, sizeof(buffer), MSG_PEEK | MSG_DONTWAIT);
@@ -223,3 +322,376 @@ bool networking::tcp_server::is_running() const
     std::shared_lock<std::shared_mutex> lock(lock_);
     return (server_.socket_ != networking::socket_t::NONE && threads_.is_running());
 }
+
+
+networking::metrics_snapshot networking::tcp_server::metrics(const networking::socket_t& sock) const
+{
+    std::shared_lock<std::shared_mutex> lock(lock_);
+    const networking::connection_table::entry* const client = clients_.find(sock);
+    if (client != nullptr) { return client->state_->metrics_.snapshot(); }
+    
+    return networking::metrics_snapshot();
+}
+
+
+std::shared_ptr<networking::connection_state> networking::tcp_server::state_of(const networking::socket_t& sock) const
+{
+    std::shared_lock<std::shared_mutex> lock(lock_);
+    const networking::connection_table::entry* const client = clients_.find(sock);
+    if (client != nullptr) { return client->state_; }
+
+    return nullptr;
+}
+
+
+// Sends what the handler left batched; a failure is already logged and recorded, and there is
+// no caller left to report it to. The state is the one taken at dispatch, so a connection the
+// handler ended is left alone even if its descriptor was reused since.
+void networking::tcp_server::handler_finished(const networking::socket_t& sock, 
+    const std::shared_ptr<networking::connection_state>& state)
+{
+    if (state != nullptr)
+    {
+        try { tcp::flush(sock, *state); }
+        catch (const networking::networking_error&) {}
+    }
+}
+
+
+networking::socket_t networking::tcp_server::accept_client(const networking::socket_t& listener, 
+    const std::function<void(const networking::connection_ref&)>& dispatch)
+{
+    lock_.lock_shared();
+    const bool is_free_slot = (clients_.size() < max_connections_);
+    lock_.unlock_shared();
+
+    if (is_running() && is_free_slot)
+    {
+        sockaddr_in client_connection = {0};
+        socklen_t client_size = sizeof(client_connection);
+        networking::socket_t client_sock;
+
+        if ((client_sock = accept(listener, (sockaddr*) &client_connection, &client_size)) == -1)
+        {
+            last_error_ = networking::error::ACCEPT_CONNECTION_ERROR;
+            const char* message = make_log(last_error_, strerror(errno));
+            throw networking::networking_error(message);
+        }
+
+        if (!apply_options(client_sock, SOCK_STREAM))
+        {
+            last_error_ = networking::error::SET_SOCKET_OPTIONS_ERROR;
+            const char* message = make_log(last_error_, strerror(errno));
+            close(client_sock);
+            throw networking::networking_error(message);
+        }
+
+        lock_.lock();
+
+        // The check above is only a hint: several acceptors may pass it at once, so the slot is
+        // claimed here and a connection over the limit is closed again.
+        if (clients_.size() >= max_connections_)
+        {
+            lock_.unlock();
+            close(client_sock);
+            last_error_ = networking::error::ACCEPT_CONNECTION_ERROR;
+            make_log(last_error_, "connection limit of " + std::to_string(max_connections_) + " reached");
+            return networking::socket_t::NONE;
+        }
+
+        metrics_.record_accept();
+        sends_.close(client_sock);
+
+        networking::connection_table::entry* const client = clients_.insert(client_sock, client_connection);
+        client->state_->metrics_.record_accept();
+        client->state_->framer_ = framing_->clone();
+
+        const std::chrono::milliseconds idle_timeout = idle_timeout_;
+        if (idle_timeout.count() > 0)
+        {
+            client->idle_timer_ = networking::timer_wheel::shared().schedule_repeating(idle_timeout, [this, client_sock]() {
+                return check_idle(client_sock);
+            });
+        }
+        const std::string client_info = client->info();
+
+        lock_.unlock();
+
+        networking::connection_ref client_ref(client_sock, client_connection);
+#ifdef SO_INCOMING_CPU
+        socklen_t cpu_size = sizeof(client_ref.cpu_);
+        if (getsockopt(client_sock, SOL_SOCKET, SO_INCOMING_CPU, &client_ref.cpu_, &cpu_size) == -1) {
+            client_ref.cpu_ = -1;
+        }
+#endif
+        dispatch(client_ref);
+
+        make_log(networking::netbase::log::CLIENT_CONNECTED_LOG, client_info);
+
+        return client_sock;
+    }
+
+    return networking::socket_t::NONE;
+}
+
+
+void networking::tcp_server::queue_connection(const networking::connection_ref& client, const std::function<void()>& task)
+{
+    const std::shared_ptr<networking::connection_state> state = state_of(client.socket_);
+    const networking::socket_t sock = client.socket_;
+
+    std::unique_lock<std::shared_mutex> lock(lock_);
+    last_connections_.push_back(sock);
+    threads_.add_task([this, task, sock, state]() {
+        task();
+        handler_finished(sock, state);
+    }, client.cpu_);
+}
+
+
+void networking::tcp_server::accept_loop(const networking::socket_t listener, 
+    const std::function<void(const networking::connection_ref&)> dispatch)
+{
+    while (serving_ && is_running())
+    {
+        try
+        {
+            if (accept_client(listener, dispatch) == networking::socket_t::NONE) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        catch (const networking::networking_error&) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+
+void networking::tcp_server::stop_serving()
+{
+    if (!acceptors_.empty())
+    {
+        serving_ = false;
+
+        shutdown(server_.socket_, SHUT_RDWR);
+        for (const auto& listener : listeners_) { shutdown(listener, SHUT_RDWR); }
+
+        for (auto& acceptor : acceptors_) { acceptor.join(); }
+        acceptors_.clear();
+    }
+}
+
+
+void networking::tcp_server::open_listener(networking::socket_t& listener)
+{
+    const int option = 1;
+    networking::error error = networking::error::NONE;
+
+    if (setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &option, sizeof(option)) == -1) {
+        error = networking::error::SET_SOCKET_OPTIONS_ERROR;
+    }
+    else if (listeners_count_ > 1 && setsockopt(listener, SOL_SOCKET, SO_REUSEPORT, &option, sizeof(option)) == -1) {
+        error = networking::error::SET_SOCKET_OPTIONS_ERROR;
+    }
+    else if (!apply_options(listener, SOCK_STREAM)) {
+        error = networking::error::SET_SOCKET_OPTIONS_ERROR;
+    }
+    else if (bind(listener, (const sockaddr*) &server_.connection_, sizeof(server_.connection_)) == -1) {
+        error = networking::error::BIND_TO_SOCKET_ERROR;
+    }
+    else if (listen(listener, max_connections_) == -1) {
+        error = networking::error::LISTEN_ON_SOCKET_ERROR;
+    }
+
+    if (error != networking::error::NONE)
+    {
+        last_error_ = error;
+        const char* message = make_log(last_error_, strerror(errno));
+        close(listener);
+        listener = networking::socket_t::NONE;
+        close_listeners();
+        throw networking::networking_error(message);
+    }
+}
+
+
+void networking::tcp_server::close_listeners()
+{
+    for (const auto& listener : listeners_) { close(listener); }
+    listeners_.clear();
+
+    if (server_.socket_ != networking::socket_t::NONE)
+    {
+        close(server_.socket_);
+        server_.socket_ = networking::socket_t::NONE;
+    }
+}
+
+
+networking::send_reactor::result networking::tcp_server::enqueue(const networking::socket_t& sock, void* const data, const std::size_t& size)
+{
+    if (!is_running() || data == nullptr || size == 0) {
+        return networking::send_reactor::result::FAILED;
+    }
+
+    networking::framer::envelope envelope;
+    if (!framing_->wrap(size, envelope))
+    {
+        last_error_ = networking::error::TRANSFER_ERROR;
+        make_log(last_error_, "message of " + std::to_string(size) + " B does not fit the framing");
+        return networking::send_reactor::result::FAILED;
+    }
+
+    const std::shared_ptr<networking::connection_state> state = state_of(sock);
+    if (state == nullptr)
+    {
+        last_error_ = networking::error::TRANSFER_ERROR;
+        make_log(last_error_, "socket " + std::to_string(sock) + " is not connected");
+        return networking::send_reactor::result::FAILED;
+    }
+
+    std::unique_lock<std::recursive_mutex> write_lock(state->write_lock_);
+    if (state->is_closed_) {
+        return networking::send_reactor::result::FAILED;
+    }
+
+    const bool is_encoded = (!is_big_endian() && framing_->is_payload_encoded());
+    if (is_encoded) {
+        reverse_byte_order((unsigned char* const) data, size);
+    }
+
+    const unsigned char* payload = static_cast<const unsigned char*>(data);
+    std::size_t payload_size = size;
+    compress(envelope, payload, payload_size);
+
+    iovec parts[3];
+    parts[0].iov_base = envelope.header_;
+    parts[0].iov_len = envelope.header_size_;
+    parts[1].iov_base = const_cast<unsigned char*>(payload);
+    parts[1].iov_len = payload_size;
+    parts[2].iov_base = envelope.trailer_;
+    parts[2].iov_len = envelope.trailer_size_;
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const networking::send_reactor::result result = post_frame(sock, *state, parts, (envelope.trailer_size_ > 0) ? 3 : 2);
+    write_lock.unlock();
+
+    if (is_encoded) {
+        reverse_byte_order((unsigned char* const) data, size);
+    }
+
+    if (result == networking::send_reactor::result::SENT || result == networking::send_reactor::result::QUEUED)
+    {
+        metrics_.record_transfer(size, elapsed_ns(start));
+        state->metrics_.record_transfer(size);
+
+        make_log(networking::netbase::log::DATA_TRANSMITTED_LOG, "TX: " + std::to_string(size));
+    }
+
+    return result;
+}
+
+
+// Called with the connection's write lock held. Frames transfer() left batched go to the queue
+// first, so the reactor sends everything in the order it was written.
+networking::send_reactor::result networking::tcp_server::post_frame(const networking::socket_t& sock, networking::connection_state& state, const iovec* const parts, const std::size_t& count)
+{
+    std::vector<unsigned char>& buffer = state.write_buffer_;
+    if (!buffer.empty())
+    {
+        iovec batched;
+        batched.iov_base = buffer.data();
+        batched.iov_len = buffer.size();
+
+        const networking::send_reactor::result result = sends_.post(sock, &batched, 1);
+        if (result == networking::send_reactor::result::FULL || result == networking::send_reactor::result::FAILED) {
+            return result;
+        }
+
+        buffer.clear();
+    }
+
+    return sends_.post(sock, parts, count);
+}
+
+
+bool networking::tcp_server::is_send_queued(const networking::socket_t& sock) const
+{
+    return (sends_.queued_bytes(sock) > 0);
+}
+
+
+// Runs on the reactor thread, which like the timer wheel must never block on lock_. A socket
+// that end() has closed in the meantime is left alone, as its descriptor may belong to a new
+// connection by now.
+void networking::tcp_server::send_failed(const networking::socket_t& sock, const int& error)
+{
+    if (!sends_.shutdown_failed(sock)) {
+        return;
+    }
+
+    if (lock_.try_lock_shared())
+    {
+        networking::connection_table::entry* const client = clients_.find(sock);
+        if (client != nullptr) { client->state_->metrics_.record_error(networking::error::TRANSFER_ERROR); }
+        lock_.unlock_shared();
+    }
+
+    make_log(networking::error::TRANSFER_ERROR, strerror(error));
+}
+
+
+networking::connection_ref::connection_ref(const networking::socket_t& sock, const sockaddr_in& connection) :
+    socket_(sock), connection_(connection)
+{
+
+}
+
+
+std::string networking::connection_ref::info() const
+{
+    std::stringstream s_info;
+    s_info << "IP address: " << ip_address() << "   Port: " << port() << "   Socket: " << socket_;
+    return s_info.str();
+}
+
+
+// Runs on the timer wheel thread, which must never block on lock_: a handler may hold it while
+// stuck in recv, and end() cancels idle timers while holding it.
+std::chrono::milliseconds networking::tcp_server::check_idle(const networking::socket_t& sock)
+{
+    if (!lock_.try_lock_shared()) {
+        return std::chrono::milliseconds(10);
+    }
+
+    networking::connection_table::entry* const client = clients_.find(sock);
+    const std::chrono::milliseconds idle_timeout = idle_timeout_;
+    if (client == nullptr || idle_timeout.count() <= 0)
+    {
+        lock_.unlock_shared();
+        return std::chrono::milliseconds(0);
+    }
+
+    const std::chrono::steady_clock::duration idle = std::chrono::steady_clock::now() - client->state_->metrics_.last_activity();
+    if (idle < idle_timeout)
+    {
+        lock_.unlock_shared();
+        return std::chrono::ceil<std::chrono::milliseconds>(idle_timeout - idle);
+    }
+
+    client->state_->metrics_.record_error(networking::error::TIMEOUT_ERROR);
+    const std::string client_info = client->info();
+    shutdown(sock, SHUT_RDWR);
+    lock_.unlock_shared();
+
+    make_log(networking::error::TIMEOUT_ERROR, client_info);
+    return std::chrono::milliseconds(0);
+}
+
+
+std::uint16_t networking::tcp_server::initial_threads(const std::uint16_t& max_connections)
+{
+    const unsigned int cores = std::max(1U, std::thread::hardware_concurrency());
+    return static_cast<std::uint16_t>(std::min<unsigned int>(max_connections, cores));
+}
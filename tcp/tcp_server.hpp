@@ -3,20 +3,42 @@
 #include "tcp.hpp"
 #include "networking_error.hpp"
 #include "thread_pool.hpp"
+#include "connection_table.hpp"
+#include "send_reactor.hpp"
 #include <cerrno>
 #include <cstring>
 #include <list>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 
 namespace networking
 {
+    struct connection_ref
+    {
+        public:
+            connection_ref() = default;
+            connection_ref(const networking::socket_t& sock, const sockaddr_in& connection);
+
+            std::string ip_address() const;
+            std::uint16_t port() const;
+            std::string info() const;
+
+            networking::socket_t socket_;
+            sockaddr_in connection_ = {0};
+            int cpu_ = -1;
+    };
+
+
     class tcp_server : public tcp
     {
         public:
             tcp_server() = default;
             tcp_server(const std::string& ip_address, const std::uint16_t& port, 
                 const networking::communication& communication_type, 
-                const std::uint16_t& max_connections, const std::string& log_file_path = "");
+                const std::uint16_t& max_connections, const std::string& log_file_path = "", 
+                const networking::socket_options& options = networking::socket_options());
             tcp_server(const tcp_server& obj) = delete;
             tcp_server(tcp_server&& obj) = delete;
             ~tcp_server() = default;
@@ -27,14 +49,36 @@ namespace networking
             void reset() override;
             void reload(const std::string& ip_address, const std::uint16_t& port, 
                 const networking::communication& communication_type, 
-                const std::uint16_t& max_connections, const std::string& log_file_path = "");
+                const std::uint16_t& max_connections, const std::string& log_file_path = "", 
+                const networking::socket_options& options = networking::socket_options());
             void start() override;
             void end() override;
             void end(const networking::socket_t& sock);
             networking::socket_t handle(const std::function<void()>& task);
+            networking::socket_t handle(const std::function<void(networking::connection_ref)>& task);
+            void serve(const std::function<void()>& task);
+            void serve(const std::function<void(networking::connection_ref)>& task);
             networking::socket_t last_connection();
+            std::uint16_t min_threads() const;
+            std::uint16_t max_threads() const;
+            void threads_limits(const std::uint16_t& min_threads, const std::uint16_t& max_threads);
+            thread_pool::placement_policy placement() const;
+            void placement(const thread_pool::placement_policy& policy);
+            std::uint16_t listeners_count() const;
+            void listeners_count(const std::uint16_t& listeners_count);
+            std::chrono::milliseconds idle_timeout() const;
+            void idle_timeout(const std::chrono::milliseconds& timeout);
             bool is_connected(const networking::socket_t& sock) const;
             bool is_running() const override;
+            networking::metrics_snapshot metrics(const networking::socket_t& sock) const;
+            using tcp::metrics;
+            networking::send_reactor::watermarks send_limits() const;
+            void send_limits(const networking::send_reactor::watermarks& limits);
+            void on_high_watermark(const networking::send_reactor::watermark_callback& callback);
+            void on_low_watermark(const networking::send_reactor::watermark_callback& callback);
+            std::size_t queued_bytes(const networking::socket_t& sock) const;
+            std::size_t receive_frames(const networking::socket_t& sock, const networking::framer::frame_callback& on_frame);
+            bool flush(const networking::socket_t& sock);
 
             template<typename T>
             bool transfer(const networking::socket_t& sock, T* const data, const std::size_t& count)
@@ -43,13 +87,39 @@ namespace networking
             }
 
 
+            // Non-blocking counterpart of transfer(): whatever the socket does not take at once is
+            // queued and sent by the reactor thread, after any frames transfer() left batched.
+            // transfer() on the same socket fails until the queue has drained.
+            template<typename T>
+            networking::send_reactor::result post(const networking::socket_t& sock, T* const data, const std::size_t& count)
+            {
+                return enqueue(sock, data, (sizeof(T) * count));
+            }
+
+
+            template<typename T>
+            bool transfer_message(const networking::socket_t& sock, const T& message)
+            {
+                return tcp::transfer_message(sock, message);
+            }
+
+            template<typename T>
+            std::size_t receive_messages(const networking::socket_t& sock, 
+                const std::function<void(const networking::message_view<T>&)>& on_message)
+            {
+                return tcp::receive_messages<T>(sock, on_message);
+            }
+
             template<typename T, typename RT>
             RT receive(const networking::socket_t& sock)
             {
                 std::size_t count = 0;
                 receive_byte_count(sock, count);
         
-                if (count > 0)
+                if (count % sizeof(T) != 0) {
+                    reject_message(sock, count, sizeof(T));
+                }
+                else if (count > 0)
                 {
                     RT buffer(count / sizeof(T));
                     if (tcp::receive(sock, buffer.data(), count))
@@ -62,13 +132,119 @@ namespace networking
             }
 
 
+        protected:
+            std::shared_ptr<networking::connection_state> state_of(const networking::socket_t& sock) const override;
+            bool is_send_queued(const networking::socket_t& sock) const override;
+
+
         private:
-            std::list<connection> clients_;
+            networking::socket_t accept_client(const networking::socket_t& listener, 
+                const std::function<void(const networking::connection_ref&)>& dispatch);
+            void queue_connection(const networking::connection_ref& client, const std::function<void()>& task);
+            void handler_finished(const networking::socket_t& sock, const std::shared_ptr<networking::connection_state>& state);
+            void start_acceptors(const std::function<void(const networking::connection_ref&)>& dispatch);
+            void accept_loop(const networking::socket_t listener, 
+                const std::function<void(const networking::connection_ref&)> dispatch);
+            void stop_serving();
+            void open_listener(networking::socket_t& listener);
+            void close_listeners();
+            networking::send_reactor::result enqueue(const networking::socket_t& sock, void* const data, const std::size_t& size);
+            networking::send_reactor::result post_frame(const networking::socket_t& sock, networking::connection_state& state, const iovec* const parts, const std::size_t& count);
+            void send_failed(const networking::socket_t& sock, const int& error);
+            std::chrono::milliseconds check_idle(const networking::socket_t& sock);
+            static std::uint16_t initial_threads(const std::uint16_t& max_connections);
+
+
+        private:
+            networking::connection_table clients_;
             std::list<networking::socket_t> last_connections_;
             std::uint16_t max_connections_ = 0;
             thread_pool threads_;
+            networking::send_reactor sends_;
+            std::uint16_t listeners_count_ = 1;
+            std::vector<networking::socket_t> listeners_;
+            std::vector<std::thread> acceptors_;
+            std::atomic<bool> serving_ = false;
+            std::atomic<std::chrono::milliseconds> idle_timeout_ = std::chrono::milliseconds(0);
     };
 }
 
 
+inline std::string networking::connection_ref::ip_address() const
+{
+    return networking::netbase::address_string(connection_.sin_addr);
+}
+
+inline std::uint16_t networking::connection_ref::port() const
+{
+    return ntohs(connection_.sin_port);
+}
+
+inline std::uint16_t networking::tcp_server::min_threads() const
+{
+    return threads_.min_threads();
+}
+
+inline std::uint16_t networking::tcp_server::max_threads() const
+{
+    return threads_.max_threads();
+}
+
+inline thread_pool::placement_policy networking::tcp_server::placement() const
+{
+    return threads_.placement();
+}
+
+inline std::uint16_t networking::tcp_server::listeners_count() const
+{
+    return listeners_count_;
+}
+
+inline std::chrono::milliseconds networking::tcp_server::idle_timeout() const
+{
+    return idle_timeout_;
+}
+
+inline void networking::tcp_server::idle_timeout(const std::chrono::milliseconds& timeout)
+{
+    idle_timeout_ = timeout;
+}
+
+inline networking::send_reactor::watermarks networking::tcp_server::send_limits() const
+{
+    return sends_.limits();
+}
+
+inline void networking::tcp_server::send_limits(const networking::send_reactor::watermarks& limits)
+{
+    sends_.limits(limits);
+}
+
+inline void networking::tcp_server::on_high_watermark(const networking::send_reactor::watermark_callback& callback)
+{
+    sends_.on_high_watermark(callback);
+}
+
+inline void networking::tcp_server::on_low_watermark(const networking::send_reactor::watermark_callback& callback)
+{
+    sends_.on_low_watermark(callback);
+}
+
+inline std::size_t networking::tcp_server::receive_frames(const networking::socket_t& sock, 
+    const networking::framer::frame_callback& on_frame)
+{
+    return tcp::receive_frames(sock, on_frame);
+}
+
+inline bool networking::tcp_server::flush(const networking::socket_t& sock)
+{
+    return tcp::flush(sock);
+}
+
+inline std::size_t networking::tcp_server::queued_bytes(const networking::socket_t& sock) const
+{
+    return sends_.queued_bytes(sock);
+}
+
+
 #endif
\ No newline at end of file
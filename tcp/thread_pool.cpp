@@ -1,22 +1,44 @@
 #include "thread_pool.hpp"
-#include <mutex>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <dirent.h>
+#include <pthread.h>
+
+
+static thread_local bool current_task_expired = false;
 
 
 thread_pool::thread_pool(const std::uint16_t& threads_count) :
-    threads_(threads_count)
+    min_threads_(threads_count), max_threads_(threads_count)
 {
 
 }
 
 
+thread_pool::thread_pool(const std::uint16_t& min_threads, const std::uint16_t& max_threads) :
+    min_threads_(std::min(min_threads, max_threads)), max_threads_(max_threads)
+{
+
+}
+
+
+thread_pool::~thread_pool()
+{
+    stop();
+}
+
+
 void thread_pool::run()
 {
     if (run_ == false)
     {
-        std::unique_lock<std::shared_mutex> lock(lock_);
+        std::unique_lock<std::mutex> lock(lock_);
         run_ = true;
-        for (auto& ti : threads_) {
-            ti.thread_ = std::thread(&thread_pool::worker, this, std::ref(ti));
+        for (std::uint16_t i = 0; i < min_threads_; ++i) {
+            spawn_thread();
         }
     }
 }
@@ -26,41 +48,57 @@ void thread_pool::stop()
 {
     if (run_)
     {
-        std::unique_lock<std::shared_mutex> lock(lock_);
-        tasks_.clear();
+        std::list<std::unique_ptr<thread_info>> threads;
+
+        lock_.lock();
+        for (auto& tasks : tasks_) { tasks.clear(); }
+        queue_size_.value_ = 0;
         run_ = false;
-        for (auto& ti : threads_) {
-            ti.thread_.join();
+        wake_all_threads();
+        threads.swap(threads_);
+        lock_.unlock();
+        idle_cv_.notify_all();
+
+        for (auto& ti : threads) {
+            ti->thread_.join();
         }
+
+        lock_.lock();
+        retire_count_ = 0;
+        finished_count_ = 0;
+        next_slot_ = 0;
+        threads_count_.value_ = 0;
+        lock_.unlock();
     }
 }
 
 
 void thread_pool::wait()
 {
-    if (run_) {
-        while (is_busy_thread());
+    if (run_)
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+        idle_cv_.wait(lock, [this]() { return (!run_ || busy_count_.value_.load(std::memory_order_relaxed) == 0); });
     }
-} 
+}
 
 
-void thread_pool::add_task(const std::function<void()>& task)
+void thread_pool::add_task(pool_task&& task)
 {
-    if (run_)
-    {
-        std::unique_lock<std::shared_mutex> lock(lock_);
-        tasks_.push_back(task);
-    }
+    push_task(std::move(task), -1, thread_pool::priority::NORMAL, std::chrono::steady_clock::time_point::max());
 }
 
 
-void thread_pool::add_task(std::function<void()>&& task)
+void thread_pool::add_task(pool_task&& task, const int& cpu)
 {
-    if (run_)
-    {
-        std::unique_lock<std::shared_mutex> lock(lock_);
-        tasks_.push_back(std::move(task));
-    }
+    push_task(std::move(task), cpu, thread_pool::priority::NORMAL, std::chrono::steady_clock::time_point::max());
+}
+
+
+void thread_pool::add_task(pool_task&& task, const thread_pool::priority& level, 
+    const std::chrono::steady_clock::time_point& deadline)
+{
+    push_task(std::move(task), -1, level, deadline);
 }
 
 
@@ -70,87 +108,263 @@ void thread_pool::reset()
     stop();
     threads_.clear();
     run_ = false;
-    tasks_.clear();
+    for (auto& tasks : tasks_) { tasks.clear(); }
+    queue_size_.value_ = 0;
 }
 
 
 std::uint16_t thread_pool::threads_count() const
 {
-    return threads_.size();
+    return threads_count_.value_.load(std::memory_order_relaxed);
 }
 
 
 void thread_pool::threads_count(const std::uint16_t& threads_count)
 {
-    if (run_ == false) {
-        threads_.resize(threads_count);
-    }
+    limits(threads_count, threads_count);
 }
 
 
-bool thread_pool::is_free_thread() const
+std::uint16_t thread_pool::min_threads() const
 {
+    std::unique_lock<std::mutex> lock(lock_);
+    return min_threads_;
+}
+
+
+std::uint16_t thread_pool::max_threads() const
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    return max_threads_;
+}
+
+
+void thread_pool::limits(const std::uint16_t& min_threads, const std::uint16_t& max_threads)
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    min_threads_ = std::min(min_threads, max_threads);
+    max_threads_ = max_threads;
+
     if (run_)
     {
-        std::shared_lock<std::shared_mutex> lock(lock_);
-        for (const auto& t : threads_) {
-            if (t.is_task_ == false) { return true; }
+        reap_threads();
+
+        const std::uint16_t count = threads_count();
+        if (count < min_threads_)
+        {
+            for (std::uint16_t i = count; i < min_threads_; ++i) { spawn_thread(); }
+        }
+        else if (count - retire_count_ > max_threads_)
+        {
+            retire_count_ = count - max_threads_;
+            wake_all_threads();
         }
     }
+}
 
-    return false;
+
+std::chrono::milliseconds thread_pool::idle_timeout() const
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    return idle_timeout_;
 }
 
 
-bool thread_pool::is_busy_thread() const
+void thread_pool::idle_timeout(const std::chrono::milliseconds& timeout)
 {
-    if (run_)
+    std::unique_lock<std::mutex> lock(lock_);
+    idle_timeout_ = timeout;
+}
+
+
+std::chrono::microseconds thread_pool::max_queue_wait() const
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    return max_queue_wait_;
+}
+
+
+void thread_pool::max_queue_wait(const std::chrono::microseconds& wait_time)
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    max_queue_wait_ = wait_time;
+}
+
+
+std::chrono::milliseconds thread_pool::starvation_limit() const
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    return starvation_limit_;
+}
+
+
+void thread_pool::starvation_limit(const std::chrono::milliseconds& limit)
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    starvation_limit_ = limit;
+}
+
+
+thread_pool::expired_policy thread_pool::on_expired() const
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    return on_expired_;
+}
+
+
+void thread_pool::on_expired(const thread_pool::expired_policy& policy)
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    on_expired_ = policy;
+}
+
+
+std::uint64_t thread_pool::expired_tasks_count() const
+{
+    return expired_count_.load(std::memory_order_relaxed);
+}
+
+
+bool thread_pool::is_task_expired()
+{
+    return current_task_expired;
+}
+
+
+thread_pool::placement_policy thread_pool::placement() const
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    return placement_;
+}
+
+
+void thread_pool::placement(const thread_pool::placement_policy& policy)
+{
+    std::vector<std::vector<int>> sets;
+    std::vector<int> allowed = policy.cpus_;
+
+    if (allowed.empty())
     {
-        std::shared_lock<std::shared_mutex> lock(lock_);
-        for (const auto& t : threads_) {
-            if (t.is_task_ == true) { return true; }
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        sched_getaffinity(0, sizeof(cpu_set_t), &cpus);
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &cpus)) { allowed.push_back(cpu); }
         }
     }
 
-    return false;
+    if (policy.mode_ == thread_pool::placement_policy::mode::CPUS)
+    {
+        for (const auto& cpu : allowed) { sets.push_back({cpu}); }
+    }
+    else if (policy.mode_ == thread_pool::placement_policy::mode::NUMA)
+    {
+        for (const auto& node : numa_nodes())
+        {
+            std::vector<int> set;
+            std::copy_if(node.begin(), node.end(), std::back_inserter(set), [&allowed](const int& cpu) {
+                return (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end());
+            });
+            if (!set.empty()) { sets.push_back(std::move(set)); }
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(lock_);
+    placement_ = policy;
+    placement_sets_.swap(sets);
+    next_slot_ = 0;
 }
 
 
-std::uint16_t thread_pool::free_threads_count() const
+// CPU sets workers are pinned to in turn; empty when the policy does not pin them.
+std::vector<std::vector<int>> thread_pool::placement_sets() const
 {
-    std::uint16_t count = 0;
+    std::unique_lock<std::mutex> lock(lock_);
+    return placement_sets_;
+}
 
-    if (run_)
+
+std::vector<std::vector<int>> thread_pool::numa_nodes()
+{
+    std::vector<std::pair<int, std::vector<int>>> nodes;
+
+    if (DIR* dir = opendir("/sys/devices/system/node"))
     {
-        std::shared_lock<std::shared_mutex> lock(lock_);
-        for (const auto& t : threads_) {
-            if (t.is_task_ == false) { count += 1; }
+        while (dirent* entry = readdir(dir))
+        {
+            const std::string name = entry->d_name;
+            if (name.size() <= 4 || name.compare(0, 4, "node") != 0 || 
+                name.find_first_not_of("0123456789", 4) != std::string::npos) {
+                continue;
+            }
+
+            std::ifstream file("/sys/devices/system/node/" + name + "/cpulist");
+            std::string range;
+            std::vector<int> cpus;
+            while (std::getline(file, range, ','))
+            {
+                const std::size_t dash = range.find('-');
+                const int first = std::atoi(range.c_str());
+                const int last = (dash == std::string::npos) ? first : std::atoi(range.c_str() + dash + 1);
+                for (int cpu = first; cpu <= last; ++cpu) { cpus.push_back(cpu); }
+            }
+
+            if (!cpus.empty()) { nodes.emplace_back(std::atoi(name.c_str() + 4), std::move(cpus)); }
+        }
+        closedir(dir);
+    }
+
+    std::sort(nodes.begin(), nodes.end());
+    std::vector<std::vector<int>> result;
+    for (auto& node : nodes) { result.push_back(std::move(node.second)); }
+
+    if (result.empty())
+    {
+        result.emplace_back();
+        for (unsigned int cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu) { 
+            result.back().push_back(static_cast<int>(cpu)); 
         }
     }
 
-    return count;
+    return result;
+}
+
+
+bool thread_pool::is_free_thread() const
+{
+    return (free_threads_count() > 0);
+}
+
+
+bool thread_pool::is_busy_thread() const
+{
+    return (busy_threads_count() > 0);
+}
+
+
+std::uint16_t thread_pool::free_threads_count() const
+{
+    if (run_) {
+        return threads_count() - busy_threads_count();
+    }
+
+    return 0;
 }
 
 
 std::uint16_t thread_pool::busy_threads_count() const
 {
-    std::uint16_t count = 0;
-    if (run_)
-    {
-        std::shared_lock<std::shared_mutex> lock(lock_);
-        for (const auto& t : threads_) {
-            if (t.is_task_ == true) { count += 1; }
-        }
+    if (run_) {
+        return busy_count_.value_.load(std::memory_order_relaxed);
     }
 
-    return count;
+    return 0;
 }
 
 
 std::size_t thread_pool::tasks_queue_size() const
 {
-    std::shared_lock<std::shared_mutex> lock(lock_);
-    return tasks_.size();
+    return queue_size_.value_.load(std::memory_order_relaxed);
 }
 
 
@@ -160,26 +374,289 @@ bool thread_pool::is_running() const
 }
 
 
+void thread_pool::push_task(pool_task&& task, const int& cpu, const thread_pool::priority& level, 
+    const std::chrono::steady_clock::time_point& deadline)
+{
+    if (run_ && task)
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+        queue_size_.value_.fetch_add(1, std::memory_order_relaxed);
+        if (finished_count_ > 0) { reap_threads(); }
+
+        if (cpu >= 0 && cpu < CPU_SETSIZE)
+        {
+            auto idle = std::find_if(idle_threads_.rbegin(), idle_threads_.rend(), [&cpu](const thread_info* ti) {
+                return (ti->is_pinned_ && CPU_ISSET(cpu, &ti->cpus_));
+            });
+
+            if (idle != idle_threads_.rend())
+            {
+                thread_info* ti = *idle;
+                idle_threads_.erase(std::next(idle).base());
+                ti->mailbox_ = queued_task{std::move(task), std::chrono::steady_clock::now()};
+                ti->is_idle_ = false;
+                ti->cv_.notify_one();
+                return;
+            }
+        }
+
+        tasks_[static_cast<std::size_t>(level)].push_back(queued_task{std::move(task), std::chrono::steady_clock::now(), deadline});
+
+        if (!wake_thread() && threads_count() - retire_count_ < max_threads_)
+        {
+            reap_threads();
+            spawn_thread();
+        }
+    }
+}
+
+
+void thread_pool::commit_tasks(const std::size_t& count)
+{
+    queue_size_.value_.fetch_add(count, std::memory_order_relaxed);
+
+    std::size_t woken = 0;
+    for (; woken < count && wake_thread(); ++woken) {}
+
+    if (woken < count)
+    {
+        reap_threads();
+        for (; woken < count && threads_count() - retire_count_ < max_threads_; ++woken) { spawn_thread(); }
+    }
+}
+
+
+bool thread_pool::wake_thread()
+{
+    if (idle_threads_.empty()) {
+        return false;
+    }
+
+    thread_info* ti = idle_threads_.back();
+    idle_threads_.pop_back();
+    ti->is_idle_ = false;
+    ti->cv_.notify_one();
+    return true;
+}
+
+
+void thread_pool::wake_all_threads()
+{
+    for (auto& ti : idle_threads_)
+    {
+        ti->is_idle_ = false;
+        ti->cv_.notify_one();
+    }
+
+    idle_threads_.clear();
+}
+
+
 void thread_pool::worker(thread_info& ti)
 {
-    std::function<void()> task;
+    if (ti.is_pinned_) {
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &ti.cpus_);
+    }
+
+    std::unique_lock<std::mutex> lock(lock_);
     while (run_)
     {
-        if (!tasks_.empty())
+        queued_task task;
+        if (ti.mailbox_.task_)
+        {
+            task = std::move(ti.mailbox_);
+            ti.mailbox_.task_ = nullptr;
+        }
+        else if (retire_count_ > 0)
+        {
+            retire_count_ -= 1;
+            break;
+        }
+        else if (!pop_task(task))
+        {
+            ti.is_idle_ = true;
+            idle_threads_.push_back(&ti);
+            ti.cv_.wait_for(lock, idle_timeout_, [&ti]() { return !ti.is_idle_; });
+
+            if (ti.is_idle_)
+            {
+                ti.is_idle_ = false;
+                idle_threads_.erase(std::find(idle_threads_.begin(), idle_threads_.end(), &ti));
+                if (threads_count() > min_threads_) { break; }
+            }
+            continue;
+        }
+
+        busy_count_.value_.fetch_add(1, std::memory_order_relaxed);
+        queue_size_.value_.fetch_sub(1, std::memory_order_relaxed);
+        ti.is_task_.store(true, std::memory_order_relaxed);
+
+        if (is_task_queued() && idle_threads_.empty() && threads_count() - retire_count_ < max_threads_ && 
+            std::chrono::steady_clock::now() - task.enqueued_ > max_queue_wait_)
+        {
+            spawn_thread();
+        }
+
+        lock.unlock();
+        current_task_expired = task.is_expired_;
+        if (task.task_) { task.task_(); }
+        current_task_expired = false;
+        lock.lock();
+
+        ti.is_task_.store(false, std::memory_order_relaxed);
+        if (busy_count_.value_.fetch_sub(1, std::memory_order_release) == 1) { idle_cv_.notify_all(); }
+    }
+
+    // Threads that left before this one are joined now rather than on the next spawn, which
+    // may never come once a spike is over; the last one is joined by the next task or stop().
+    threads_count_.value_.fetch_sub(1, std::memory_order_relaxed);
+    reap_threads();
+    ti.is_finished_ = true;
+    finished_count_ += 1;
+}
+
+
+bool thread_pool::pop_task(queued_task& task)
+{
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    while (is_task_queued())
+    {
+        // Higher classes go first, unless the head of a lower class has waited longer than
+        // the starvation limit; then the longest waiting head is served instead.
+        std::size_t level = PRIORITIES_COUNT;
+        std::chrono::steady_clock::duration longest_wait = starvation_limit_;
+
+        for (std::size_t i = 0; i < PRIORITIES_COUNT; ++i)
         {
-            if (lock_.try_lock())
+            if (!tasks_[i].empty())
             {
-                task = std::move(tasks_.front());
-                tasks_.pop_front();
-                ti.is_task_ = true;
-                lock_.unlock();
+                if (level == PRIORITIES_COUNT) { level = i; }
+                else if (now - tasks_[i].front().enqueued_ > longest_wait)
+                {
+                    level = i;
+                    longest_wait = now - tasks_[i].front().enqueued_;
+                }
+            }
+        }
 
-                if (task) { task(); }
+        task = std::move(tasks_[level].front());
+        tasks_[level].pop_front();
+        task.is_expired_ = (now > task.deadline_);
 
-                lock_.lock();
-                ti.is_task_ = false;
-                lock_.unlock();
+        if (task.is_expired_)
+        {
+            expired_count_.fetch_add(1, std::memory_order_relaxed);
+            if (on_expired_ == thread_pool::expired_policy::DROP)
+            {
+                queue_size_.value_.fetch_sub(1, std::memory_order_relaxed);
+                continue;
             }
         }
+
+        return true;
+    }
+
+    return false;
+}
+
+
+bool thread_pool::is_task_queued() const
+{
+    return std::any_of(tasks_.begin(), tasks_.end(), [](const thread_pool::task_queue& tasks) { return !tasks.empty(); });
+}
+
+
+void thread_pool::place_thread(thread_info& ti)
+{
+    CPU_ZERO(&ti.cpus_);
+    ti.is_pinned_ = !placement_sets_.empty();
+
+    if (ti.is_pinned_)
+    {
+        for (const auto& cpu : placement_sets_[next_slot_ % placement_sets_.size()]) {
+            CPU_SET(cpu, &ti.cpus_);
+        }
+        next_slot_ += 1;
+    }
+}
+
+
+void thread_pool::spawn_thread()
+{
+    threads_.emplace_back(new thread_info);
+    place_thread(*threads_.back());
+    threads_count_.value_.fetch_add(1, std::memory_order_relaxed);
+    threads_.back()->thread_ = std::thread(&thread_pool::worker, this, std::ref(*threads_.back()));
+}
+
+
+void thread_pool::reap_threads()
+{
+    for (auto ti = threads_.begin(); ti != threads_.end();)
+    {
+        if ((*ti)->is_finished_)
+        {
+            (*ti)->thread_.join();
+            ti = threads_.erase(ti);
+            finished_count_ -= 1;
+        }
+        else { ++ti; }
     }
-}
\ No newline at end of file
+}
+
+
+bool thread_pool::task_queue::empty() const
+{
+    return (size_ == 0);
+}
+
+
+std::size_t thread_pool::task_queue::size() const
+{
+    return size_;
+}
+
+
+thread_pool::queued_task& thread_pool::task_queue::front()
+{
+    return tasks_[head_];
+}
+
+
+void thread_pool::task_queue::push_back(queued_task&& task)
+{
+    if (size_ == tasks_.size())
+    {
+        std::vector<queued_task> tasks(std::max<std::size_t>(16, tasks_.size() * 2));
+        for (std::size_t i = 0; i < size_; ++i) {
+            tasks[i] = std::move(tasks_[(head_ + i) % tasks_.size()]);
+        }
+
+        tasks_.swap(tasks);
+        head_ = 0;
+    }
+
+    tasks_[(head_ + size_) % tasks_.size()] = std::move(task);
+    size_ += 1;
+}
+
+
+void thread_pool::task_queue::pop_front()
+{
+    tasks_[head_] = queued_task();
+    head_ = (head_ + 1) % tasks_.size();
+    size_ -= 1;
+}
+
+
+void thread_pool::task_queue::clear()
+{
+    for (; size_ > 0; --size_)
+    {
+        tasks_[head_] = queued_task();
+        head_ = (head_ + 1) % tasks_.size();
+    }
+
+    head_ = 0;
+}
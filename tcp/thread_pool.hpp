@@ -1,21 +1,56 @@
 #ifndef __THREAD_POOL_HPP__
 #define __THREAD_POOL_HPP__
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cinttypes>
+#include <condition_variable>
 #include <thread>
 #include <vector>
 #include <list>
-#include <shared_mutex>
+#include <memory>
+#include <mutex>
 #include <functional>
+#include <iterator>
+#include <type_traits>
+#include "pool_task.hpp"
+#include "pool_future.hpp"
+#include <sched.h>
 
 
 class thread_pool
 {
+    public:
+        struct placement_policy
+        {
+            enum class mode
+            {
+                NONE, CPUS, NUMA
+            };
+
+            thread_pool::placement_policy::mode mode_ = thread_pool::placement_policy::mode::NONE;
+            std::vector<int> cpus_;
+        };
+
+        enum class priority : std::uint8_t
+        {
+            HIGH, NORMAL, LOW
+        };
+
+        enum class expired_policy : std::uint8_t
+        {
+            DROP, RUN
+        };
+
+        static constexpr std::size_t PRIORITIES_COUNT = 3;
+
     public:
         thread_pool() = default;
         thread_pool(const std::uint16_t& threads_count);
+        thread_pool(const std::uint16_t& min_threads, const std::uint16_t& max_threads);
         thread_pool(const thread_pool& obj) = delete;
         thread_pool(thread_pool&& obj) = delete;
-        ~thread_pool() = default;
+        ~thread_pool();
 
         thread_pool& operator=(const thread_pool& obj) = delete;
         thread_pool& operator=(thread_pool&& obj) = delete;
@@ -24,10 +59,81 @@ class thread_pool
         void run();
         void stop();
         void wait();
-        void add_task(const std::function<void()>& task);
-        void add_task(std::function<void()>&& task);
+        void add_task(pool_task&& task);
+        void add_task(pool_task&& task, const int& cpu);
+        void add_task(pool_task&& task, const thread_pool::priority& level, 
+            const std::chrono::steady_clock::time_point& deadline = std::chrono::steady_clock::time_point::max());
+
+        template<typename Iterator>
+        void add_tasks(Iterator first, const Iterator last, const thread_pool::priority& level = thread_pool::priority::NORMAL)
+        {
+            if (run_)
+            {
+                std::unique_lock<std::mutex> lock(lock_);
+                const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                std::size_t count = 0;
+
+                try
+                {
+                    for (; first != last; ++first, ++count) {
+                        tasks_[static_cast<std::size_t>(level)].push_back(queued_task{pool_task(*first), now});
+                    }
+                }
+                catch (...)
+                {
+                    commit_tasks(count);
+                    throw;
+                }
+
+                commit_tasks(count);
+            }
+        }
+
+        template<typename Range>
+        void add_tasks(Range&& range, const thread_pool::priority& level = thread_pool::priority::NORMAL)
+        {
+            if constexpr (std::is_lvalue_reference_v<Range>) {
+                add_tasks(std::begin(range), std::end(range), level);
+            }
+            else {
+                add_tasks(std::make_move_iterator(std::begin(range)), std::make_move_iterator(std::end(range)), level);
+            }
+        }
+
+        template<typename F>
+        auto submit(F&& f) -> pool_future<std::invoke_result_t<std::decay_t<F>&>>
+        {
+            return submit(std::forward<F>(f), thread_pool::priority::NORMAL);
+        }
+
+        template<typename F>
+        auto submit(F&& f, const thread_pool::priority& level, 
+            const std::chrono::steady_clock::time_point& deadline = std::chrono::steady_clock::time_point::max()) 
+            -> pool_future<std::invoke_result_t<std::decay_t<F>&>>
+        {
+            using result_type = std::invoke_result_t<std::decay_t<F>&>;
+            pool_state<result_type>* const state = pool_state<result_type>::acquire();
+            add_task(pool_call<result_type, std::decay_t<F>>(state, std::decay_t<F>(std::forward<F>(f))), level, deadline);
+            return pool_future<result_type>(state);
+        }
+
         std::uint16_t threads_count() const;
         void threads_count(const std::uint16_t& threads_count);
+        std::uint16_t min_threads() const;
+        std::uint16_t max_threads() const;
+        void limits(const std::uint16_t& min_threads, const std::uint16_t& max_threads);
+        std::chrono::milliseconds idle_timeout() const;
+        void idle_timeout(const std::chrono::milliseconds& timeout);
+        std::chrono::microseconds max_queue_wait() const;
+        void max_queue_wait(const std::chrono::microseconds& wait_time);
+        std::chrono::milliseconds starvation_limit() const;
+        void starvation_limit(const std::chrono::milliseconds& limit);
+        thread_pool::expired_policy on_expired() const;
+        void on_expired(const thread_pool::expired_policy& policy);
+        std::uint64_t expired_tasks_count() const;
+        thread_pool::placement_policy placement() const;
+        void placement(const thread_pool::placement_policy& policy);
+        std::vector<std::vector<int>> placement_sets() const;
         bool is_free_thread() const;
         bool is_busy_thread() const;
         std::uint16_t free_threads_count() const;
@@ -35,22 +141,97 @@ class thread_pool
         std::size_t tasks_queue_size() const;
         bool is_running() const;
 
+        static bool is_task_expired();
+        static std::vector<std::vector<int>> numa_nodes();
+
 
     private:
-        struct thread_info
+        static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+        struct queued_task
+        {
+            pool_task task_;
+            std::chrono::steady_clock::time_point enqueued_;
+            std::chrono::steady_clock::time_point deadline_ = std::chrono::steady_clock::time_point::max();
+            bool is_expired_ = false;
+        };
+
+        // Growable ring buffer: once it has reached the working size, queueing a task
+        // costs no allocation, unlike a node based list.
+        class task_queue
+        {
+            public:
+                bool empty() const;
+                std::size_t size() const;
+                queued_task& front();
+                void push_back(queued_task&& task);
+                void pop_front();
+                void clear();
+
+
+            private:
+                std::vector<queued_task> tasks_;
+                std::size_t head_ = 0;
+                std::size_t size_ = 0;
+        };
+
+        // Each worker owns a whole cache line, so flipping its own state never
+        // invalidates the line of a neighbouring worker. Idle workers sleep on their
+        // own condition variable and are woken one at a time, optionally with a
+        // task handed straight to them.
+        struct alignas(CACHE_LINE_SIZE) thread_info
         {
             std::thread thread_;
-            bool is_task_ = false;
+            std::condition_variable cv_;
+            queued_task mailbox_;
+            cpu_set_t cpus_;
+            bool is_pinned_ = false;
+            bool is_idle_ = false;
+            bool is_finished_ = false;
+            std::atomic<bool> is_task_ = false;
+        };
+
+        template<typename T>
+        struct alignas(CACHE_LINE_SIZE) padded
+        {
+            std::atomic<T> value_;
         };
 
         void worker(thread_info& ti);
+        void spawn_thread();
+        void reap_threads();
+        void push_task(pool_task&& task, const int& cpu, const thread_pool::priority& level, 
+            const std::chrono::steady_clock::time_point& deadline);
+        void commit_tasks(const std::size_t& count);
+        bool pop_task(queued_task& task);
+        bool is_task_queued() const;
+        bool wake_thread();
+        void wake_all_threads();
+        void place_thread(thread_info& ti);
 
-        bool run_ = false;
-        std::vector<thread_info> threads_;
-        std::list<std::function<void()>> tasks_;
-        mutable std::shared_mutex lock_;
+        std::atomic<bool> run_ = false;
+        std::uint16_t min_threads_ = 0;
+        std::uint16_t max_threads_ = 0;
+        std::uint16_t retire_count_ = 0;
+        std::uint16_t finished_count_ = 0;
+        std::size_t next_slot_ = 0;
+        std::chrono::milliseconds idle_timeout_ = std::chrono::seconds(10);
+        std::chrono::microseconds max_queue_wait_ = std::chrono::milliseconds(1);
+        std::chrono::milliseconds starvation_limit_ = std::chrono::milliseconds(20);
+        thread_pool::expired_policy on_expired_ = thread_pool::expired_policy::DROP;
+        thread_pool::placement_policy placement_;
+        std::vector<std::vector<int>> placement_sets_;
+        std::list<std::unique_ptr<thread_info>> threads_;
+        std::vector<thread_info*> idle_threads_;
+        std::array<thread_pool::task_queue, PRIORITIES_COUNT> tasks_;
+        padded<std::uint16_t> threads_count_ = {0};
+        padded<std::size_t> queue_size_ = {0};
+        padded<std::uint16_t> busy_count_ = {0};
+        std::atomic<std::uint64_t> expired_count_ = 0;
+        std::condition_variable idle_cv_;
+        mutable std::mutex lock_;
 };
 
 
 
-#endif
\ No newline at end of file
+#endif
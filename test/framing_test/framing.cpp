@@ -0,0 +1,222 @@
+#include "frame_header.hpp"
+#include "framer.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+static std::size_t failures = 0;
+
+
+static void check(const bool& condition, const std::string& what)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << what << "\n";
+        ++failures;
+    }
+}
+
+
+static void header_round_trip(const std::uint64_t& length, const std::size_t& expected_size)
+{
+    const std::string name = "length " + std::to_string(length);
+    unsigned char header[networking::frame_header::MAX_SIZE];
+    std::memset(header, 0xAA, sizeof(header));
+
+    check(networking::frame_header::encoded_size(length) == expected_size, name + " encoded size");
+    check(networking::frame_header::encode(length, header) == expected_size, name + " encode size");
+    check(networking::frame_header::size(header[0]) == expected_size, name + " size from first byte");
+    check(networking::frame_header::decode(header) == length, name + " decode");
+    check(networking::frame_header::codec(header[0]) == 0, name + " codec");
+}
+
+
+static void header_checks()
+{
+    header_round_trip(0, 1);
+    header_round_trip(127, 1);
+    header_round_trip(128, 2);
+    header_round_trip(16383, 2);
+    header_round_trip(16384, 4);
+    header_round_trip((1ULL << 29) - 1, 4);
+    header_round_trip(1ULL << 29, 9);
+    header_round_trip(0xFFFFFFFFFFFFFFFFULL, 9);
+
+    unsigned char header[networking::frame_header::MAX_SIZE];
+    networking::frame_header::encode(1ULL << 29, header);
+    const unsigned char nine_byte_form[] = { 0xFF, 0, 0, 0, 0, 0x20, 0, 0, 0 };
+    check(std::memcmp(header, nine_byte_form, sizeof(nine_byte_form)) == 0, "9-byte form layout");
+
+    for (unsigned int first = 0xE0; first <= 0xFE; ++first) {
+        check(networking::frame_header::size(static_cast<unsigned char>(first)) == 0, "reserved prefix " + std::to_string(first));
+    }
+
+    check(networking::frame_header::codec(0xE3) == 3, "codec prefix");
+    check(networking::frame_header::codec(0xF3) == 0, "non-codec prefix");
+}
+
+
+static std::vector<unsigned char> make_payload(const std::size_t& size)
+{
+    std::vector<unsigned char> payload(size);
+    for (std::size_t i = 0; i < size; ++i) { payload[i] = static_cast<unsigned char>(i * 7 + size); }
+    return payload;
+}
+
+
+static std::vector<unsigned char> make_stream(const networking::framer& framer, const std::vector<std::size_t>& sizes)
+{
+    std::vector<unsigned char> stream;
+    for (const auto& size : sizes)
+    {
+        networking::framer::envelope frame;
+        framer.wrap(size, frame);
+
+        const std::vector<unsigned char> payload = make_payload(size);
+        stream.insert(stream.end(), frame.header_, frame.header_ + frame.header_size_);
+        stream.insert(stream.end(), payload.begin(), payload.end());
+        stream.insert(stream.end(), frame.trailer_, frame.trailer_ + frame.trailer_size_);
+    }
+
+    return stream;
+}
+
+
+// Feeds the stream in chunks of chunk_size bytes, or all at once when it is zero, and checks
+// that every frame comes out whole and in order.
+static void feed_checks(networking::framer& framer, const std::vector<std::size_t>& sizes, const std::string& name)
+{
+    const std::vector<unsigned char> stream = make_stream(framer, sizes);
+    const std::size_t chunk_sizes[] = { 0, 1, 2, 3, 7, 127, 128, 4096 };
+
+    for (const auto& chunk_size : chunk_sizes)
+    {
+        const std::string what = name + " chunks of " + std::to_string(chunk_size);
+        std::size_t received = 0;
+        bool is_intact = true;
+
+        const networking::framer::frame_callback on_frame = [&](unsigned char* const payload, const std::size_t& size) {
+            if (received >= sizes.size() || size != sizes[received] ||
+                std::memcmp(payload, make_payload(size).data(), size) != 0) {
+                is_intact = false;
+            }
+            ++received;
+        };
+
+        framer.reset();
+        const std::size_t step = (chunk_size == 0) ? stream.size() : chunk_size;
+        bool is_wellformed = true;
+
+        for (std::size_t offset = 0; offset < stream.size(); offset += step) {
+            is_wellformed &= framer.feed(stream.data() + offset, std::min(step, stream.size() - offset), on_frame);
+        }
+
+        check(is_wellformed, what + " well-formed");
+        check(is_intact, what + " payloads");
+        check(received == sizes.size(), what + " frame count");
+        check(framer.buffered() == 0, what + " nothing left over");
+    }
+}
+
+
+static void front_pop_checks()
+{
+    networking::length_prefix_framer framer;
+    const std::vector<unsigned char> stream = make_stream(framer, { 3, 200 });
+    unsigned char* payload = nullptr;
+    std::size_t size = 0;
+
+    std::memcpy(framer.prepare(2), stream.data(), 2);
+    framer.commit(2);
+    check(framer.front(payload, size) == networking::framer::status::INCOMPLETE, "front on partial frame");
+    check(!framer.has_complete_frame(), "no complete frame while partial");
+
+    std::memcpy(framer.prepare(stream.size() - 2), stream.data() + 2, stream.size() - 2);
+    framer.commit(stream.size() - 2);
+    check(framer.has_complete_frame(), "complete frame once whole");
+    check(framer.buffered() == stream.size(), "has_complete_frame leaves the buffer alone");
+    check(framer.front(payload, size) == networking::framer::status::COMPLETE && size == 3, "front on first frame");
+    check(framer.front(payload, size) == networking::framer::status::COMPLETE && size == 3, "front is repeatable");
+    framer.pop();
+    check(framer.front(payload, size) == networking::framer::status::COMPLETE && size == 200, "front on second frame");
+    check(std::memcmp(payload, make_payload(200).data(), 200) == 0, "second frame payload");
+    framer.pop();
+    check(framer.front(payload, size) == networking::framer::status::INCOMPLETE, "front once drained");
+}
+
+
+static void malformed_checks()
+{
+    networking::length_prefix_framer framer(1024);
+
+    for (unsigned int first = 0xF0; first <= 0xFE; ++first)
+    {
+        const unsigned char stream[] = { static_cast<unsigned char>(first), 0, 0, 0 };
+        framer.reset();
+        check(!framer.feed(stream, sizeof(stream), nullptr), "reserved prefix " + std::to_string(first) + " rejected");
+    }
+
+    const unsigned char reserved[] = { 0xF5, 0, 0 };
+    framer.reset();
+    std::memcpy(framer.prepare(sizeof(reserved)), reserved, sizeof(reserved));
+    framer.commit(sizeof(reserved));
+    check(!framer.has_complete_frame() && framer.buffered() == sizeof(reserved), "has_complete_frame keeps malformed input");
+
+    const unsigned char no_codec[] = { 0xE0, 0x01, 0x00 };
+    framer.reset();
+    check(!framer.feed(no_codec, sizeof(no_codec), nullptr), "codec prefix without a codec rejected");
+
+    unsigned char oversized[networking::frame_header::MAX_SIZE];
+    const std::size_t oversized_size = networking::frame_header::encode(1025, oversized);
+    framer.reset();
+    check(!framer.feed(oversized, oversized_size, nullptr), "frame above max_frame_size rejected");
+
+    networking::framer::envelope frame;
+    framer.wrap_compressed(5, 2, frame);
+    const std::vector<unsigned char> payload = make_payload(5);
+    std::vector<unsigned char> compressed(frame.header_, frame.header_ + frame.header_size_);
+    compressed.insert(compressed.end(), payload.begin(), payload.end());
+
+    unsigned char* front_payload = nullptr;
+    std::size_t front_size = 0;
+    framer.reset();
+    std::memcpy(framer.prepare(1), compressed.data(), 1);
+    framer.commit(1);
+    check(framer.front(front_payload, front_size) == networking::framer::status::INCOMPLETE, "codec prefix alone");
+    std::memcpy(framer.prepare(compressed.size() - 1), compressed.data() + 1, compressed.size() - 1);
+    framer.commit(compressed.size() - 1);
+    check(framer.front(front_payload, front_size) == networking::framer::status::COMPLETE && front_size == 5,
+        "compressed frame split after its prefix");
+    check(framer.front_codec() == 2, "compressed frame codec");
+}
+
+
+int main()
+{
+    header_checks();
+
+    networking::length_prefix_framer length_prefix;
+    feed_checks(length_prefix, { 0, 1, 127, 128, 300, 16383, 16384, 5 }, "length prefix");
+
+    networking::delimiter_framer delimiter("\r\n");
+    feed_checks(delimiter, { 0, 1, 127, 128, 300, 5 }, "delimiter");
+
+    networking::fixed_size_framer fixed_size(130);
+    feed_checks(fixed_size, { 130, 130, 130 }, "fixed size");
+
+    front_pop_checks();
+    malformed_checks();
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " check(s) failed\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "all framing checks passed\n";
+    return EXIT_SUCCESS;
+}
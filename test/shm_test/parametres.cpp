@@ -0,0 +1,7 @@
+#include "parametres.hpp"
+
+
+const char name_1[] = "networking_endpoint_1";
+const char log_file_path_1[] = "endpoint_1_log.log";
+const char name_2[] = "networking_endpoint_2";
+const char log_file_path_2[] = "endpoint_2_log.log";
\ No newline at end of file
@@ -0,0 +1,11 @@
+#ifndef __PARAMETRES_HPP__
+#define __PARAMETRES_HPP__
+
+
+extern const char name_1[];
+extern const char log_file_path_1[];
+extern const char name_2[];
+extern const char log_file_path_2[];
+
+
+#endif
\ No newline at end of file
@@ -10,7 +10,7 @@
 #include <thread>
 
 
-static networking::tcp_client client(ip_address, port, networking::communication::REMOTE, log_file_path_client);
+static networking::tcp_client client(ip_address, port, networking::communication::REMOTE, log_file_path_client, socket_options);
 
 
 void client_terminate(int sig)
@@ -61,7 +61,7 @@ int main()
                 std::vector<char> buffer;
                 while (client.is_running())
                 {
-                    if (client.is_data_to_receive())
+                    if (client.wait_readable(std::chrono::milliseconds(500)) && client.is_data_to_receive())
                     {
                         buffer = client.receive<char, std::vector<char>>();
                         if (!buffer.empty())
@@ -5,3 +5,8 @@ const int port = 54000;
 const int max_connections = 3;
 const char* const log_file_path_server = "server_log.log";
 const char* const log_file_path_client = "client_log.log";
+const networking::socket_options socket_options = [] {
+    networking::socket_options options;
+    options.no_delay_ = true;
+    return options;
+}();
@@ -1,5 +1,6 @@
 #ifndef __PARAMETRES_HPP__
 #define __PARAMETRES_HPP__
+#include "socket_options.hpp"
 
 
 extern const char* const ip_address;
@@ -7,6 +8,7 @@ extern const int port;
 extern const int max_connections;
 extern const char* const log_file_path_server;
 extern const char* const log_file_path_client;
+extern const networking::socket_options socket_options;
 
 
 #endif
\ No newline at end of file
@@ -7,7 +7,7 @@
 #include <string>
 
 
-static networking::tcp_server server(ip_address, port, networking::communication::REMOTE, max_connections, log_file_path_server);
+static networking::tcp_server server(ip_address, port, networking::communication::REMOTE, max_connections, log_file_path_server, socket_options);
 
 
 void server_terminate(int sig)
@@ -42,27 +42,24 @@ int main()
 
         while (server.is_running())
         {
-            server.handle([]()
+            server.handle([](networking::connection_ref client)
             {
                 try
                 {
-                    const networking::socket_t sock = server.last_connection();
+                    const networking::socket_t sock = client.socket_;
                     std::vector<char> buffer;
                     char server_reply[] = "Data arrived OK";
 
-                    while (server.is_connected(sock))
+                    while (server.wait_readable(sock) && server.is_connected(sock))
                     {
-                        if (server.is_data_to_receive(sock))
+                        buffer = server.receive<char, std::vector<char>>(sock);
+                        if (!buffer.empty())
                         {
-                            buffer = server.receive<char, std::vector<char>>(sock);
-                            if (!buffer.empty())
-                            {
-                                for (const auto& i : buffer) { std::cout << i; }
-                                putchar('\n');
-                                buffer.clear();
-                                
-                                server.transfer<char>(sock, server_reply, sizeof(server_reply));
-                            }
+                            for (const auto& i : buffer) { std::cout << i; }
+                            putchar('\n');
+                            buffer.clear();
+                            
+                            server.transfer<char>(sock, server_reply, sizeof(server_reply));
                         }
                     }
 
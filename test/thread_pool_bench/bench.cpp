@@ -0,0 +1,353 @@
+#include "thread_pool.hpp"
+#include "reference_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+
+
+using bench_clock = std::chrono::steady_clock;
+
+
+struct bench_config
+{
+    std::uint16_t max_threads = 4;
+    std::size_t latency_samples = 1000;
+    std::size_t throughput_tasks = 100000;
+    std::chrono::milliseconds idle_period = std::chrono::milliseconds(1000);
+};
+
+
+static double to_us(const bench_clock::duration& d)
+{
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+
+static double cpu_seconds()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+
+static std::vector<std::uint16_t> thread_steps(const std::uint16_t& max_threads)
+{
+    std::vector<std::uint16_t> steps;
+    for (std::uint16_t i = 1; i < max_threads; i *= 2) { steps.push_back(i); }
+    steps.push_back(max_threads);
+    return steps;
+}
+
+
+template<typename Pool>
+void latency_bench(const std::string& name, const bench_config& config, const std::uint16_t& workers)
+{
+    std::unique_ptr<Pool> pool(new Pool(workers));
+    pool->run();
+
+    std::vector<bench_clock::duration> samples;
+    samples.reserve(config.latency_samples);
+
+    for (std::size_t i = 0; i < config.latency_samples; ++i)
+    {
+        std::atomic<bool> started(false);
+        bench_clock::time_point start_time;
+
+        const bench_clock::time_point submit_time = bench_clock::now();
+        pool->add_task([&started, &start_time]()
+        {
+            start_time = bench_clock::now();
+            started.store(true, std::memory_order_release);
+        });
+
+        while (!started.load(std::memory_order_acquire)) { std::this_thread::yield(); }
+        samples.push_back(start_time - submit_time);
+    }
+
+    pool->stop();
+
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](const double& p) {
+        return to_us(samples[std::min(samples.size() - 1, static_cast<std::size_t>(p * samples.size()))]);
+    };
+
+    std::cout << std::left << std::setw(16) << name << std::setw(10) << workers
+              << std::fixed << std::setprecision(2)
+              << std::setw(12) << percentile(0.50) << std::setw(12) << percentile(0.90)
+              << std::setw(12) << percentile(0.99) << std::setw(12) << percentile(0.999)
+              << to_us(samples.back()) << '\n';
+}
+
+
+template<typename Pool>
+void throughput_bench(const std::string& name, const bench_config& config, const std::uint16_t& producers, const std::uint16_t& workers)
+{
+    std::unique_ptr<Pool> pool(new Pool(workers));
+    pool->run();
+
+    const std::size_t tasks_per_producer = config.throughput_tasks / producers;
+    const std::size_t total = tasks_per_producer * producers;
+    std::atomic<std::size_t> done(0);
+    std::atomic<bool> go(false);
+
+    std::vector<std::thread> producer_threads;
+    for (std::uint16_t p = 0; p < producers; ++p)
+    {
+        producer_threads.emplace_back([&pool, &done, &go, tasks_per_producer]()
+        {
+            while (!go.load(std::memory_order_acquire)) { std::this_thread::yield(); }
+            for (std::size_t i = 0; i < tasks_per_producer; ++i) {
+                pool->add_task([&done]() { done.fetch_add(1, std::memory_order_relaxed); });
+            }
+        });
+    }
+
+    const bench_clock::time_point start = bench_clock::now();
+    go.store(true, std::memory_order_release);
+
+    for (auto& t : producer_threads) { t.join(); }
+    const bench_clock::duration submit_time = bench_clock::now() - start;
+
+    while (done.load(std::memory_order_relaxed) < total) { std::this_thread::yield(); }
+    const bench_clock::duration total_time = bench_clock::now() - start;
+
+    pool->stop();
+
+    const double seconds = std::chrono::duration<double>(total_time).count();
+    std::cout << std::left << std::setw(16) << name << std::setw(11) << producers << std::setw(10) << workers
+              << std::fixed << std::setprecision(0)
+              << std::setw(16) << (total / seconds)
+              << std::setprecision(1) << std::setw(14) << (to_us(submit_time) * 1000.0 / total)
+              << (to_us(total_time) * 1000.0 / total) << '\n';
+}
+
+
+template<typename Pool>
+void idle_bench(const std::string& name, const bench_config& config, const std::uint16_t& workers)
+{
+    std::unique_ptr<Pool> pool(new Pool(workers));
+    pool->run();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    const double cpu_start = cpu_seconds();
+    const bench_clock::time_point start = bench_clock::now();
+    std::this_thread::sleep_for(config.idle_period);
+    const double cpu_used = cpu_seconds() - cpu_start;
+    const double wall = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+    pool->stop();
+
+    std::cout << std::left << std::setw(16) << name << std::setw(10) << workers
+              << std::fixed << std::setprecision(1) << (cpu_used / wall * 100.0) << '\n';
+}
+
+
+static void priority_bench(const bench_config& config, const thread_pool::priority& level, const std::uint16_t& workers)
+{
+    constexpr std::size_t BULK_TASKS = 200;
+    thread_pool pool(workers);
+    pool.run();
+
+    auto bulk_task = []() {
+        const bench_clock::time_point end = bench_clock::now() + std::chrono::microseconds(5);
+        while (bench_clock::now() < end) {}
+    };
+
+    std::vector<bench_clock::duration> samples;
+    for (std::size_t i = 0; i < std::max<std::size_t>(1, config.latency_samples / 10); ++i)
+    {
+        std::atomic<bool> started(false);
+        bench_clock::time_point start_time;
+
+        for (std::size_t j = 0; j < BULK_TASKS; ++j) { pool.add_task(bulk_task, thread_pool::priority::LOW); }
+
+        const bench_clock::time_point submit_time = bench_clock::now();
+        pool.add_task([&started, &start_time]()
+        {
+            start_time = bench_clock::now();
+            started.store(true, std::memory_order_release);
+        }, level);
+
+        while (!started.load(std::memory_order_acquire)) { std::this_thread::yield(); }
+        samples.push_back(start_time - submit_time);
+        pool.wait();
+    }
+
+    pool.stop();
+
+    std::sort(samples.begin(), samples.end());
+    std::cout << std::left << std::setw(16) << (level == thread_pool::priority::HIGH ? "HIGH" : "LOW")
+              << std::setw(10) << workers << std::fixed << std::setprecision(2)
+              << std::setw(12) << to_us(samples[samples.size() / 2])
+              << to_us(samples[std::min(samples.size() - 1, samples.size() * 99 / 100)]) << '\n';
+}
+
+
+static void batch_bench(const bench_config& config, const std::size_t& batch, const std::uint16_t& workers)
+{
+    thread_pool pool(workers);
+    pool.run();
+
+    const std::size_t total = (config.throughput_tasks / batch) * batch;
+    std::atomic<std::size_t> done(0);
+    std::vector<std::function<void()>> tasks(batch, [&done]() { done.fetch_add(1, std::memory_order_relaxed); });
+
+    const bench_clock::time_point start = bench_clock::now();
+    for (std::size_t i = 0; i < total; i += batch)
+    {
+        if (batch == 1) { pool.add_task(tasks.front()); }
+        else { pool.add_tasks(tasks); }
+    }
+    const bench_clock::duration submit_time = bench_clock::now() - start;
+
+    while (done.load(std::memory_order_relaxed) < total) { std::this_thread::yield(); }
+    const bench_clock::duration total_time = bench_clock::now() - start;
+
+    pool.stop();
+
+    std::cout << std::left << std::setw(16) << batch << std::setw(10) << workers << std::fixed << std::setprecision(0)
+              << std::setw(16) << (total / std::chrono::duration<double>(total_time).count())
+              << std::setprecision(1) << std::setw(14) << (to_us(submit_time) * 1000.0 / total)
+              << (to_us(total_time) * 1000.0 / total) << '\n';
+}
+
+
+static void submit_bench(const bench_config& config, const std::uint16_t& workers)
+{
+    thread_pool pool(workers);
+    pool.run();
+
+    std::vector<bench_clock::duration> samples;
+    samples.reserve(config.latency_samples);
+
+    for (std::size_t i = 0; i < config.latency_samples; ++i)
+    {
+        const bench_clock::time_point submit_time = bench_clock::now();
+        pool.submit([i]() { return i; }).get();
+        samples.push_back(bench_clock::now() - submit_time);
+    }
+
+    pool.stop();
+
+    std::sort(samples.begin(), samples.end());
+    std::cout << std::left << std::setw(16) << "thread_pool" << std::setw(10) << workers << std::fixed << std::setprecision(2)
+              << std::setw(12) << to_us(samples[samples.size() / 2])
+              << to_us(samples[std::min(samples.size() - 1, samples.size() * 99 / 100)]) << '\n';
+}
+
+
+// Empty callables must be skipped by the workers; one that ran would throw and terminate.
+static void empty_task_check(const std::uint16_t& workers)
+{
+    thread_pool pool(workers);
+    pool.run();
+
+    std::atomic<std::size_t> done(0);
+    void (*null_function)() = nullptr;
+
+    pool.add_task(std::function<void()>());
+    pool.add_task(null_function);
+    pool.add_tasks(std::vector<std::function<void()>>(10));
+    pool.add_task([&done]() { done.fetch_add(1, std::memory_order_relaxed); });
+
+    while (done.load(std::memory_order_relaxed) < 1) { std::this_thread::yield(); }
+    pool.wait();
+    pool.stop();
+
+    std::cout << std::left << std::setw(16) << "thread_pool" << std::setw(10) << workers << "skipped\n";
+}
+
+
+template<typename Pool>
+void run_suite(const std::string& name, const bench_config& config, const char* const section)
+{
+    const std::vector<std::uint16_t> steps = thread_steps(config.max_threads);
+    const std::string which = section;
+
+    if (which == "latency")
+    {
+        for (const auto& workers : steps) { latency_bench<Pool>(name, config, workers); }
+    }
+    else if (which == "throughput")
+    {
+        for (const auto& producers : steps) {
+            for (const auto& workers : steps) { throughput_bench<Pool>(name, config, producers, workers); }
+        }
+    }
+    else if (which == "idle")
+    {
+        for (const auto& workers : steps) { idle_bench<Pool>(name, config, workers); }
+    }
+}
+
+
+static void run_pools(const bench_config& config, const char* const section)
+{
+    run_suite<reference_pool>("reference_pool", config, section);
+    run_suite<thread_pool>("thread_pool", config, section);
+}
+
+
+int main(int argc, char** argv)
+{
+    bench_config config;
+    if (argc > 1) { config.max_threads = static_cast<std::uint16_t>(std::max(1, std::atoi(argv[1]))); }
+    if (argc > 2) { config.latency_samples = std::max(1, std::atoi(argv[2])); }
+    if (argc > 3) { config.throughput_tasks = std::max(1, std::atoi(argv[3])); }
+    if (argc > 4) { config.idle_period = std::chrono::milliseconds(std::max(1, std::atoi(argv[4]))); }
+
+    std::cout << "thread_pool dispatch benchmark (max threads: " << config.max_threads
+              << ", hardware threads: " << std::thread::hardware_concurrency() << ")\n\n";
+
+    std::cout << "add_task-to-start latency [us]\n"
+              << std::left << std::setw(16) << "pool" << std::setw(10) << "workers"
+              << std::setw(12) << "p50" << std::setw(12) << "p90" << std::setw(12) << "p99"
+              << std::setw(12) << "p99.9" << "max\n";
+    run_pools(config, "latency");
+
+    std::cout << "\nempty task throughput\n"
+              << std::left << std::setw(16) << "pool" << std::setw(11) << "producers" << std::setw(10) << "workers"
+              << std::setw(16) << "tasks/s" << std::setw(14) << "submit ns" << "total ns\n";
+    run_pools(config, "throughput");
+
+    std::cout << "\nidle CPU burn\n"
+              << std::left << std::setw(16) << "pool" << std::setw(10) << "workers" << "cpu %\n";
+    run_pools(config, "idle");
+
+    std::cout << "\nprobe latency behind 200 LOW bulk tasks [us]\n"
+              << std::left << std::setw(16) << "probe" << std::setw(10) << "workers" << std::setw(12) << "p50" << "p99\n";
+    for (const auto& workers : thread_steps(config.max_threads))
+    {
+        priority_bench(config, thread_pool::priority::LOW, workers);
+        priority_bench(config, thread_pool::priority::HIGH, workers);
+    }
+
+    std::cout << "\nbatched submission (add_task vs add_tasks)\n"
+              << std::left << std::setw(16) << "batch" << std::setw(10) << "workers"
+              << std::setw(16) << "tasks/s" << std::setw(14) << "submit ns" << "total ns\n";
+    for (const auto& workers : thread_steps(config.max_threads))
+    {
+        batch_bench(config, 1, workers);
+        batch_bench(config, 500, workers);
+    }
+
+    std::cout << "\nsubmit().get() round trip [us]\n"
+              << std::left << std::setw(16) << "pool" << std::setw(10) << "workers" << std::setw(12) << "p50" << "p99\n";
+    for (const auto& workers : thread_steps(config.max_threads)) { submit_bench(config, workers); }
+
+    std::cout << "\nempty tasks\n"
+              << std::left << std::setw(16) << "pool" << std::setw(10) << "workers" << "result\n";
+    for (const auto& workers : thread_steps(config.max_threads)) { empty_task_check(workers); }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,85 @@
+#include "reference_pool.hpp"
+#include <mutex>
+
+
+reference_pool::reference_pool(const std::uint16_t& threads_count) :
+    threads_(threads_count)
+{
+
+}
+
+
+reference_pool::~reference_pool()
+{
+    stop();
+}
+
+
+void reference_pool::run()
+{
+    if (run_ == false)
+    {
+        std::unique_lock<std::shared_mutex> lock(lock_);
+        run_ = true;
+        for (auto& ti : threads_) {
+            ti.thread_ = std::thread(&reference_pool::worker, this, std::ref(ti));
+        }
+    }
+}
+
+
+void reference_pool::stop()
+{
+    if (run_)
+    {
+        lock_.lock();
+        tasks_.clear();
+        run_ = false;
+        lock_.unlock();
+
+        for (auto& ti : threads_) {
+            ti.thread_.join();
+        }
+    }
+}
+
+
+void reference_pool::add_task(std::function<void()>&& task)
+{
+    if (run_)
+    {
+        std::unique_lock<std::shared_mutex> lock(lock_);
+        tasks_.push_back(std::move(task));
+    }
+}
+
+
+void reference_pool::worker(thread_info& ti)
+{
+    std::function<void()> task;
+    while (run_)
+    {
+        if (!tasks_.empty())
+        {
+            if (lock_.try_lock())
+            {
+                if (tasks_.empty())
+                {
+                    lock_.unlock();
+                    continue;
+                }
+
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+                ti.is_task_ = true;
+                lock_.unlock();
+
+                if (task) { task(); }
+
+                lock_.lock();
+                ti.is_task_ = false;
+                lock_.unlock();
+            }
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef __REFERENCE_POOL_HPP__
+#define __REFERENCE_POOL_HPP__
+#include <cinttypes>
+#include <thread>
+#include <vector>
+#include <list>
+#include <shared_mutex>
+#include <functional>
+
+
+// Frozen copy of the original std::list + std::shared_mutex thread_pool dispatch,
+// kept as the baseline the current thread_pool is measured against.
+class reference_pool
+{
+    public:
+        reference_pool(const std::uint16_t& threads_count);
+        reference_pool(const reference_pool& obj) = delete;
+        reference_pool(reference_pool&& obj) = delete;
+        ~reference_pool();
+
+        reference_pool& operator=(const reference_pool& obj) = delete;
+        reference_pool& operator=(reference_pool&& obj) = delete;
+
+        void run();
+        void stop();
+        void add_task(std::function<void()>&& task);
+
+
+    private:
+        struct thread_info
+        {
+            std::thread thread_;
+            bool is_task_ = false;
+        };
+
+        void worker(thread_info& ti);
+
+        bool run_ = false;
+        std::vector<thread_info> threads_;
+        std::list<std::function<void()>> tasks_;
+        mutable std::shared_mutex lock_;
+};
+
+
+
+#endif
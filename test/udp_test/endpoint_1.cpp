@@ -61,7 +61,7 @@ int main()
                 std::vector<char> buffer;
                 while (endpoint.is_running())
                 {
-                    if (endpoint.is_data_to_receive())
+                    if (endpoint.wait_readable(std::chrono::milliseconds(500)) && endpoint.is_data_to_receive())
                     {
                         buffer = endpoint.receive<char, std::vector<char>>();
                         if (!buffer.empty())
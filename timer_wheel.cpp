@@ -0,0 +1,331 @@
+#include "timer_wheel.hpp"
+#include <algorithm>
+
+
+static constexpr std::size_t SLOT_BITS = 6;
+static_assert((std::size_t(1) << SLOT_BITS) == networking::timer_wheel::SLOTS_COUNT, "SLOTS_COUNT must be 2^SLOT_BITS");
+
+
+networking::timer_wheel::timer_wheel(const std::chrono::milliseconds& resolution) :
+    resolution_(std::max(resolution, std::chrono::milliseconds(1))), epoch_(std::chrono::steady_clock::now())
+{
+    slots_.fill(-1);
+    thread_ = std::thread(&timer_wheel::run, this);
+}
+
+
+networking::timer_wheel::~timer_wheel()
+{
+    lock_.lock();
+    stop_ = true;
+    lock_.unlock();
+
+    tick_cv_.notify_all();
+    thread_.join();
+}
+
+
+networking::timer_wheel& networking::timer_wheel::shared()
+{
+    // Never destroyed: endpoints with static storage may still cancel their timers at exit.
+    static networking::timer_wheel* const wheel = new networking::timer_wheel();
+    return *wheel;
+}
+
+
+networking::timer_wheel::timer_id networking::timer_wheel::schedule(const std::chrono::milliseconds& delay, std::function<void()> callback)
+{
+    return insert(delay, [callback = std::move(callback)]() {
+        callback();
+        return std::chrono::milliseconds(0);
+    });
+}
+
+
+networking::timer_wheel::timer_id networking::timer_wheel::schedule_repeating(const std::chrono::milliseconds& delay, 
+    std::function<std::chrono::milliseconds()> callback)
+{
+    return insert(delay, std::move(callback));
+}
+
+
+bool networking::timer_wheel::reschedule(const timer_id& id, const std::chrono::milliseconds& delay)
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    node* const n = find(id);
+    if (n == nullptr) {
+        return false;
+    }
+
+    const std::int32_t index = static_cast<std::int32_t>(n - nodes_.data());
+    n->expires_ = std::max(ticks(std::chrono::steady_clock::now()), current_) + delay_ticks(delay);
+
+    if (id == running_) { is_running_rescheduled_ = true; }
+    else
+    {
+        unlink(index);
+        link(index);
+        if (n->expires_ < wake_at_) { tick_cv_.notify_one(); }
+    }
+
+    return true;
+}
+
+
+bool networking::timer_wheel::cancel(const timer_id& id)
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    node* const n = find(id);
+    if (n == nullptr) {
+        return false;
+    }
+
+    if (id == running_)
+    {
+        is_running_cancelled_ = true;
+        if (std::this_thread::get_id() != thread_.get_id()) {
+            done_cv_.wait(lock, [this, &id]() { return (running_ != id); });
+        }
+        return false;
+    }
+
+    const std::int32_t index = static_cast<std::int32_t>(n - nodes_.data());
+    unlink(index);
+    release(index);
+    return true;
+}
+
+
+networking::timer_wheel::timer_id networking::timer_wheel::insert(const std::chrono::milliseconds& delay, 
+    std::function<std::chrono::milliseconds()>&& callback)
+{
+    std::unique_lock<std::mutex> lock(lock_);
+
+    if (free_ == -1)
+    {
+        nodes_.emplace_back();
+        free_ = static_cast<std::int32_t>(nodes_.size() - 1);
+    }
+
+    const std::int32_t index = free_;
+    node& n = nodes_[index];
+    free_ = n.next_;
+
+    n.callback_ = std::move(callback);
+    n.expires_ = std::max(ticks(std::chrono::steady_clock::now()), current_) + delay_ticks(delay);
+    link(index);
+    size_ += 1;
+
+    if (n.expires_ < wake_at_) { tick_cv_.notify_one(); }
+
+    return (static_cast<timer_id>(n.generation_) << 32) | static_cast<timer_id>(index + 1);
+}
+
+
+networking::timer_wheel::node* networking::timer_wheel::find(const timer_id& id)
+{
+    const std::size_t index = static_cast<std::size_t>(id & 0xFFFFFFFF) - 1;
+    if (id == NONE || index >= nodes_.size()) {
+        return nullptr;
+    }
+
+    node& n = nodes_[index];
+    if (n.generation_ != static_cast<std::uint32_t>(id >> 32) || (!n.callback_ && id != running_)) {
+        return nullptr;
+    }
+
+    return &n;
+}
+
+
+void networking::timer_wheel::link(const std::int32_t& index)
+{
+    node& n = nodes_[index];
+    std::size_t level = 0;
+    std::size_t slot = 0;
+
+    for (; level < LEVELS_COUNT; ++level)
+    {
+        const std::size_t shift = level * SLOT_BITS;
+        if ((n.expires_ >> shift) - (current_ >> shift) < SLOTS_COUNT)
+        {
+            slot = (n.expires_ >> shift) & (SLOTS_COUNT - 1);
+            break;
+        }
+    }
+
+    if (level == LEVELS_COUNT)
+    {
+        level = LEVELS_COUNT - 1;
+        slot = ((current_ >> (level * SLOT_BITS)) + SLOTS_COUNT - 1) & (SLOTS_COUNT - 1);
+    }
+
+    const std::int32_t position = static_cast<std::int32_t>(level * SLOTS_COUNT + slot);
+    n.slot_ = position;
+    n.prev_ = -1;
+    n.next_ = slots_[position];
+    if (n.next_ != -1) { nodes_[n.next_].prev_ = index; }
+    slots_[position] = index;
+    occupied_[level] |= (std::uint64_t(1) << slot);
+}
+
+
+void networking::timer_wheel::unlink(const std::int32_t& index)
+{
+    node& n = nodes_[index];
+    if (n.slot_ == -1) {
+        return;
+    }
+
+    if (n.prev_ != -1) { nodes_[n.prev_].next_ = n.next_; }
+    else { slots_[n.slot_] = n.next_; }
+    if (n.next_ != -1) { nodes_[n.next_].prev_ = n.prev_; }
+
+    if (slots_[n.slot_] == -1) {
+        occupied_[n.slot_ / SLOTS_COUNT] &= ~(std::uint64_t(1) << (n.slot_ % SLOTS_COUNT));
+    }
+
+    n.slot_ = -1;
+    n.prev_ = -1;
+    n.next_ = -1;
+}
+
+
+void networking::timer_wheel::release(const std::int32_t& index)
+{
+    node& n = nodes_[index];
+    n.callback_ = nullptr;
+    n.generation_ += 1;
+    n.next_ = free_;
+    free_ = index;
+    size_ -= 1;
+}
+
+
+void networking::timer_wheel::advance(const std::uint64_t& target, std::vector<timer_id>& expired)
+{
+    while (current_ < target)
+    {
+        if (size_ == 0)
+        {
+            current_ = target;
+            break;
+        }
+
+        current_ = std::min(next_event(), target);
+
+        if ((current_ & (SLOTS_COUNT - 1)) == 0)
+        {
+            std::size_t level = 1;
+            while (level < LEVELS_COUNT - 1 && (current_ & ((std::uint64_t(1) << ((level + 1) * SLOT_BITS)) - 1)) == 0) { 
+                level += 1; 
+            }
+            for (; level > 0; --level) { cascade(level); }
+        }
+
+        const std::size_t slot = current_ & (SLOTS_COUNT - 1);
+        while (slots_[slot] != -1)
+        {
+            const std::int32_t index = slots_[slot];
+            unlink(index);
+            expired.push_back((static_cast<timer_id>(nodes_[index].generation_) << 32) | static_cast<timer_id>(index + 1));
+        }
+    }
+}
+
+
+void networking::timer_wheel::cascade(const std::size_t& level)
+{
+    const std::size_t position = level * SLOTS_COUNT + ((current_ >> (level * SLOT_BITS)) & (SLOTS_COUNT - 1));
+    std::int32_t index = slots_[position];
+    slots_[position] = -1;
+    occupied_[level] &= ~(std::uint64_t(1) << (position % SLOTS_COUNT));
+
+    while (index != -1)
+    {
+        const std::int32_t next = nodes_[index].next_;
+        nodes_[index].slot_ = -1;
+        link(index);
+        index = next;
+    }
+}
+
+
+std::uint64_t networking::timer_wheel::next_event() const
+{
+    const std::size_t slot = current_ & (SLOTS_COUNT - 1);
+    std::uint64_t distance = SLOTS_COUNT - slot;
+
+    const std::uint64_t ahead = (slot + 1 < SLOTS_COUNT) ? (occupied_[0] >> (slot + 1)) : 0;
+    if (ahead != 0) { distance = std::min<std::uint64_t>(distance, __builtin_ctzll(ahead) + 1); }
+
+    return current_ + distance;
+}
+
+
+std::uint64_t networking::timer_wheel::ticks(const std::chrono::steady_clock::time_point& time) const
+{
+    return static_cast<std::uint64_t>((time - epoch_) / resolution_);
+}
+
+
+std::uint64_t networking::timer_wheel::delay_ticks(const std::chrono::milliseconds& delay) const
+{
+    return std::max<std::uint64_t>(1, (delay.count() + resolution_.count() - 1) / resolution_.count());
+}
+
+
+void networking::timer_wheel::run()
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    std::vector<timer_id> expired;
+
+    while (!stop_)
+    {
+        advance(ticks(std::chrono::steady_clock::now()), expired);
+
+        for (const auto& id : expired)
+        {
+            // Skip timers cancelled or rescheduled by an earlier callback of this batch.
+            const node* const pending = find(id);
+            if (pending == nullptr || pending->slot_ != -1) {
+                continue;
+            }
+
+            const std::int32_t index = static_cast<std::int32_t>(pending - nodes_.data());
+            running_ = id;
+            std::function<std::chrono::milliseconds()> callback = std::move(nodes_[index].callback_);
+
+            lock.unlock();
+            const std::chrono::milliseconds delay = callback();
+            lock.lock();
+
+            node& n = nodes_[index];
+            if (is_running_cancelled_ || (!is_running_rescheduled_ && delay.count() <= 0)) { release(index); }
+            else
+            {
+                if (!is_running_rescheduled_) { n.expires_ = std::max(ticks(std::chrono::steady_clock::now()), current_) + delay_ticks(delay); }
+                n.callback_ = std::move(callback);
+                link(index);
+            }
+
+            running_ = NONE;
+            is_running_cancelled_ = false;
+            is_running_rescheduled_ = false;
+            done_cv_.notify_all();
+        }
+        expired.clear();
+
+        if (size_ == 0)
+        {
+            wake_at_ = UINT64_MAX;
+            tick_cv_.wait(lock, [this]() { return (stop_ || size_ > 0); });
+        }
+        else
+        {
+            wake_at_ = next_event();
+            tick_cv_.wait_until(lock, epoch_ + wake_at_ * resolution_);
+        }
+        wake_at_ = 0;
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef __NETWORKING_TIMER_WHEEL_HPP__
+#define __NETWORKING_TIMER_WHEEL_HPP__
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace networking
+{
+    // Hierarchical timing wheel: LEVELS_COUNT levels of SLOTS_COUNT slots, each level
+    // SLOTS_COUNT times coarser than the one below. Timers live in intrusive lists inside
+    // a node pool, so schedule, reschedule and cancel are O(1); expiring timers cascade down
+    // one level at a time. All timers run on a single thread and callbacks must be short.
+    class timer_wheel
+    {
+        public:
+            using timer_id = std::uint64_t;
+
+            static constexpr timer_id NONE = 0;
+            static constexpr std::size_t SLOTS_COUNT = 64;
+            static constexpr std::size_t LEVELS_COUNT = 4;
+
+        public:
+            timer_wheel(const std::chrono::milliseconds& resolution = std::chrono::milliseconds(1));
+            timer_wheel(const timer_wheel& obj) = delete;
+            timer_wheel(timer_wheel&& obj) = delete;
+            ~timer_wheel();
+
+            timer_wheel& operator=(const timer_wheel& obj) = delete;
+            timer_wheel& operator=(timer_wheel&& obj) = delete;
+
+            timer_id schedule(const std::chrono::milliseconds& delay, std::function<void()> callback);
+            timer_id schedule_repeating(const std::chrono::milliseconds& delay, std::function<std::chrono::milliseconds()> callback);
+            bool reschedule(const timer_id& id, const std::chrono::milliseconds& delay);
+            bool cancel(const timer_id& id);
+            std::size_t size() const;
+            std::chrono::milliseconds resolution() const;
+
+            static networking::timer_wheel& shared();
+
+
+        private:
+            struct node
+            {
+                std::function<std::chrono::milliseconds()> callback_;
+                std::uint64_t expires_ = 0;
+                std::uint32_t generation_ = 1;
+                std::int32_t prev_ = -1;
+                std::int32_t next_ = -1;
+                std::int32_t slot_ = -1;
+            };
+
+            timer_id insert(const std::chrono::milliseconds& delay, std::function<std::chrono::milliseconds()>&& callback);
+            node* find(const timer_id& id);
+            void link(const std::int32_t& index);
+            void unlink(const std::int32_t& index);
+            void release(const std::int32_t& index);
+            void advance(const std::uint64_t& target, std::vector<timer_id>& expired);
+            void cascade(const std::size_t& level);
+            std::uint64_t next_event() const;
+            std::uint64_t ticks(const std::chrono::steady_clock::time_point& time) const;
+            std::uint64_t delay_ticks(const std::chrono::milliseconds& delay) const;
+            void run();
+
+            const std::chrono::milliseconds resolution_;
+            const std::chrono::steady_clock::time_point epoch_;
+            std::uint64_t current_ = 0;
+            std::vector<node> nodes_;
+            std::int32_t free_ = -1;
+            std::size_t size_ = 0;
+            std::array<std::int32_t, SLOTS_COUNT * LEVELS_COUNT> slots_;
+            std::array<std::uint64_t, LEVELS_COUNT> occupied_ = {};
+            std::uint64_t wake_at_ = 0;
+            timer_id running_ = NONE;
+            bool is_running_cancelled_ = false;
+            bool is_running_rescheduled_ = false;
+            bool stop_ = false;
+            mutable std::mutex lock_;
+            std::condition_variable tick_cv_;
+            std::condition_variable done_cv_;
+            std::thread thread_;
+    };
+}
+
+
+inline std::size_t networking::timer_wheel::size() const
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    return size_;
+}
+
+inline std::chrono::milliseconds networking::timer_wheel::resolution() const
+{
+    return resolution_;
+}
+
+
+#endif
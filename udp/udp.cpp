@@ -1,10 +1,16 @@
 #include "udp.hpp"
 #include "networking_error.hpp"
+#include "frame_header.hpp"
+#include <algorithm>
 #include <cstring>
 #include <cerrno>
+#include <cstdint>
+#include <chrono>
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <poll.h>
 
 
 networking::udp::udp()
@@ -21,8 +27,9 @@ networking::udp::~udp()
 
 
 networking::udp::udp(const std::string& ip_address, const std::uint16_t& port, 
-    const networking::communication& communication_type, const std::string& log_file_path) :
-    networking::netbase(ip_address, port, communication_type, log_file_path)
+    const networking::communication& communication_type, const std::string& log_file_path, 
+    const networking::socket_options& options) :
+    networking::netbase(ip_address, port, communication_type, log_file_path, options)
 {
     if (communication_type_ == networking::communication::LOCAL) { destination_.connection_.sin_family = AF_UNIX; }
     else { destination_.connection_.sin_family = AF_INET; }
@@ -54,6 +61,8 @@ void networking::udp::reset()
     networking::netbase::reset();
     destination_.reset();
     is_destination_ = false;
+    groups_.clear();
+    destinations_.clear();
 }
 
 
@@ -70,7 +79,8 @@ void networking::udp::start()
         }
 
         const int option = 1;
-        if (setsockopt(server_.socket_, SOL_SOCKET, SO_REUSEADDR, &option, sizeof(option)) == -1)
+        if (setsockopt(server_.socket_, SOL_SOCKET, SO_REUSEADDR, &option, sizeof(option)) == -1 || 
+            !apply_options(server_.socket_, SOCK_DGRAM))
         {
             last_error_ = networking::error::SET_SOCKET_OPTIONS_ERROR;
             const char* message = make_log(last_error_, strerror(errno));
@@ -88,6 +98,25 @@ void networking::udp::start()
             throw networking::networking_error(message);
         }
 
+#ifdef IP_MULTICAST_ALL
+        // Linux otherwise delivers a group to every socket on the port once any socket on the
+        // host has joined it, so leave_group() would not stop the traffic.
+        const int is_all = 0;
+        setsockopt(server_.socket_, IPPROTO_IP, IP_MULTICAST_ALL, &is_all, sizeof(is_all));
+#endif
+
+        for (const auto& membership : groups_)
+        {
+            if (setsockopt(server_.socket_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) == -1)
+            {
+                last_error_ = networking::error::SET_SOCKET_OPTIONS_ERROR;
+                const char* message = make_log(last_error_, address_string(membership.imr_multiaddr) + ": " + strerror(errno));
+                close(server_.socket_);
+                server_.socket_ = networking::socket_t::NONE;
+                throw networking::networking_error(message);
+            }
+        }
+
         make_log(networking::netbase::log::ENDPOINT_READY_LOG, server_.info());
     }
 }
@@ -103,16 +132,145 @@ void networking::udp::end()
 
 void networking::udp::set_destination(const std::string& ip_address, const std::uint16_t& port)
 {
+    lock_.lock();
+    destination_.connection_.sin_family = (communication_type_ == networking::communication::LOCAL) ? AF_UNIX : AF_INET;
     destination_.connection_.sin_port = htons(port);
     inet_aton(ip_address.data(), &destination_.connection_.sin_addr);
     is_destination_ = true;
+    lock_.unlock();
 }
 
 
 void networking::udp::unset_destination()
 {
+    lock_.lock();
     destination_.reset();
     is_destination_ = false;
+    lock_.unlock();
+}
+
+
+void networking::udp::add_destination(const std::string& ip_address, const std::uint16_t& port)
+{
+    networking::netbase::connection peer;
+    if (!make_address(ip_address, port, peer.connection_))
+    {
+        last_error_ = networking::error::CONNECT_ERROR;
+        const char* message = make_log(last_error_, ip_address + " is not an IPv4 address");
+        throw networking::networking_error(message);
+    }
+
+    std::unique_lock<std::shared_mutex> lock(lock_);
+    const auto found = std::find_if(destinations_.begin(), destinations_.end(), [&peer](const networking::netbase::connection& added) {
+        return (std::memcmp(&added.connection_, &peer.connection_, sizeof(peer.connection_)) == 0);
+    });
+
+    if (found == destinations_.end()) {
+        destinations_.push_back(std::move(peer));
+    }
+}
+
+
+void networking::udp::remove_destination(const std::string& ip_address, const std::uint16_t& port)
+{
+    sockaddr_in address = {0};
+    if (make_address(ip_address, port, address))
+    {
+        std::unique_lock<std::shared_mutex> lock(lock_);
+        const auto found = std::find_if(destinations_.begin(), destinations_.end(), [&address](const networking::netbase::connection& added) {
+            return (std::memcmp(&added.connection_, &address, sizeof(address)) == 0);
+        });
+
+        if (found != destinations_.end()) {
+            destinations_.erase(found);
+        }
+    }
+}
+
+
+void networking::udp::clear_destinations()
+{
+    std::unique_lock<std::shared_mutex> lock(lock_);
+    destinations_.clear();
+}
+
+
+void networking::udp::join_group(const std::string& group_ip_address, const std::string& interface_ip_address)
+{
+    ip_mreq membership = {0};
+    if (!make_membership(group_ip_address, interface_ip_address, membership))
+    {
+        last_error_ = networking::error::SET_SOCKET_OPTIONS_ERROR;
+        const char* message = make_log(last_error_, group_ip_address + " on " + interface_ip_address + " is not a multicast membership");
+        throw networking::networking_error(message);
+    }
+
+    lock_.lock();
+    const auto found = std::find_if(groups_.begin(), groups_.end(), [&membership](const ip_mreq& joined) {
+        return (std::memcmp(&joined, &membership, sizeof(membership)) == 0);
+    });
+
+    if (found == groups_.end())
+    {
+        if (server_.socket_ != networking::socket_t::NONE && 
+            setsockopt(server_.socket_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) == -1)
+        {
+            last_error_ = networking::error::SET_SOCKET_OPTIONS_ERROR;
+            const int error = errno;
+            lock_.unlock();
+            const char* message = make_log(last_error_, group_ip_address + ": " + strerror(error));
+            throw networking::networking_error(message);
+        }
+
+        groups_.push_back(membership);
+    }
+    lock_.unlock();
+}
+
+
+void networking::udp::leave_group(const std::string& group_ip_address, const std::string& interface_ip_address)
+{
+    ip_mreq membership = {0};
+    if (!make_membership(group_ip_address, interface_ip_address, membership))
+    {
+        last_error_ = networking::error::SET_SOCKET_OPTIONS_ERROR;
+        const char* message = make_log(last_error_, group_ip_address + " on " + interface_ip_address + " is not a multicast membership");
+        throw networking::networking_error(message);
+    }
+
+    lock_.lock();
+    const auto found = std::find_if(groups_.begin(), groups_.end(), [&membership](const ip_mreq& joined) {
+        return (std::memcmp(&joined, &membership, sizeof(membership)) == 0);
+    });
+
+    if (found != groups_.end())
+    {
+        // The membership is only forgotten once the socket has dropped it, so after a failed
+        // leave groups() still lists a group whose traffic keeps arriving.
+        if (server_.socket_ != networking::socket_t::NONE && 
+            setsockopt(server_.socket_, IPPROTO_IP, IP_DROP_MEMBERSHIP, &membership, sizeof(membership)) == -1)
+        {
+            last_error_ = networking::error::SET_SOCKET_OPTIONS_ERROR;
+            const int error = errno;
+            lock_.unlock();
+            const char* message = make_log(last_error_, group_ip_address + ": " + strerror(error));
+            throw networking::networking_error(message);
+        }
+
+        groups_.erase(found);
+    }
+    lock_.unlock();
+}
+
+
+std::vector<std::string> networking::udp::groups() const
+{
+    std::vector<std::string> groups;
+    std::shared_lock<std::shared_mutex> lock(lock_);
+
+    groups.reserve(groups_.size());
+    for (const auto& membership : groups_) { groups.push_back(address_string(membership.imr_multiaddr)); }
+    return groups;
 }
 
 
@@ -129,6 +287,18 @@ bool networking::udp::is_data_to_receive() const
 }
 
 
+bool networking::udp::wait_readable(const std::chrono::milliseconds& timeout)
+{
+    return netbase::wait_readable(server_.socket_, timeout);
+}
+
+
+bool networking::udp::wait_writable(const std::chrono::milliseconds& timeout)
+{
+    return netbase::wait_writable(server_.socket_, timeout);
+}
+
+
 bool networking::udp::is_data_to_receive(const networking::socket_t& sock) const
 {
     if (sock != networking::socket_t::NONE && is_running())
@@ -150,35 +320,41 @@ bool networking::udp::transfer(const networking::socket_t& sock, void* const dat
     bool sent = false;
     if (is_destination() && is_running())
     {
-        std::size_t count;
-        if (!is_big_endian())
-        {
+        if (!is_big_endian()) {
             reverse_byte_order((unsigned char* const) data, size);
-            count = htonl(size);
         }
-        else { count = size; }
 
-        lock_.lock();
-        if (sendto(sock, &count, sizeof(count), 0, 
-            (const sockaddr*) &destination_.connection_, sizeof(destination_.connection_)) < 0)
-        {
-            last_error_ = networking::error::TRANSFER_ERROR;
-            lock_.unlock();
-            const char* message = make_log(last_error_, strerror(errno)); 
-            throw networking::networking_error(message);
-        }
+        unsigned char header[networking::frame_header::MAX_SIZE];
+        iovec parts[2];
+        parts[0].iov_base = header;
+        parts[0].iov_len = networking::frame_header::encode(size, header);
+        parts[1].iov_base = data;
+        parts[1].iov_len = size;
+
+        msghdr datagram = {0};
+        datagram.msg_name = &destination_.connection_;
+        datagram.msg_namelen = sizeof(destination_.connection_);
+        datagram.msg_iov = parts;
+        datagram.msg_iovlen = 2;
 
-        if (sendto(sock, data, size, 0, 
-            (const sockaddr*) &destination_.connection_, sizeof(destination_.connection_)) < 0)
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        lock_.lock();
+        if (sendmsg(sock, &datagram, 0) < 0)
         {
             last_error_ = networking::error::TRANSFER_ERROR;
             lock_.unlock();
+            if (!is_big_endian()) {
+                reverse_byte_order((unsigned char* const) data, size);
+            }
             const char* message = make_log(last_error_, strerror(errno)); 
             throw networking::networking_error(message);
         }
     
         lock_.unlock();
 
+        metrics_.record_transfer(size, elapsed_ns(start));
+
         if (!is_big_endian()) {
             reverse_byte_order((unsigned char* const) data, size);
         }
@@ -198,12 +374,31 @@ bool networking::udp::receive(const networking::socket_t& sock, void* const data
     bool sent = false;
     if (is_destination() && is_running())
     {
-        socklen_t len =  sizeof(destination_.connection_);
         networking::netbase::connection source;
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        if (operation_timeout_.count() > 0 && !wait_for(sock, POLLIN, operation_timeout_))
+        {
+            last_error_ = networking::error::TIMEOUT_ERROR;
+            make_log(last_error_);
+            return false;
+        }
+
+        unsigned char header[networking::frame_header::MAX_SIZE];
+        iovec parts[2];
+        parts[0].iov_base = header;
+        parts[0].iov_len = networking::frame_header::encoded_size(size);
+        parts[1].iov_base = data;
+        parts[1].iov_len = size;
+
+        msghdr datagram = {0};
+        datagram.msg_name = &source.connection_;
+        datagram.msg_namelen = sizeof(source.connection_);
+        datagram.msg_iov = parts;
+        datagram.msg_iovlen = 2;
 
         lock_.lock();
-        if (recvfrom(sock, data, size, 0, 
-            (sockaddr*) &source.connection_, &len) < 0)
+        if (recvmsg(sock, &datagram, 0) < 0)
         {
             last_error_ = networking::error::RECEIVE_ERROR;
             lock_.unlock();
@@ -212,6 +407,8 @@ bool networking::udp::receive(const networking::socket_t& sock, void* const data
         }
         lock_.unlock();
 
+        metrics_.record_receive(size, elapsed_ns(start));
+
         if (!is_big_endian()) {
             reverse_byte_order((unsigned char* const) data, size);
         }
@@ -226,22 +423,146 @@ bool networking::udp::receive(const networking::socket_t& sock, void* const data
 }
 
 
+bool networking::udp::make_membership(const std::string& group_ip_address, const std::string& interface_ip_address, 
+    ip_mreq& membership) const
+{
+    return (inet_aton(group_ip_address.data(), &membership.imr_multiaddr) != 0 && 
+        IN_MULTICAST(ntohl(membership.imr_multiaddr.s_addr)) && 
+        inet_aton(interface_ip_address.data(), &membership.imr_interface) != 0);
+}
+
+
+bool networking::udp::make_address(const std::string& ip_address, const std::uint16_t& port, sockaddr_in& address) const
+{
+    address.sin_family = (communication_type_ == networking::communication::LOCAL) ? AF_UNIX : AF_INET;
+    address.sin_port = htons(port);
+    return (inet_aton(ip_address.data(), &address.sin_addr) != 0);
+}
+
+
+// The payload is encoded and framed once; every message of the batch points at the same parts
+// and only the address differs. sendmmsg() stops at the first peer it cannot send to, which is
+// recorded and skipped before the rest of the batch is resubmitted.
+std::size_t networking::udp::transfer_all(const networking::socket_t& sock, void* const data, const std::size_t& size, 
+    std::vector<networking::udp::delivery>* const failures)
+{
+    if (!is_running() || data == nullptr || size == 0) {
+        return 0;
+    }
+
+    if (!is_big_endian()) {
+        reverse_byte_order((unsigned char* const) data, size);
+    }
+
+    unsigned char header[networking::frame_header::MAX_SIZE];
+    iovec parts[2];
+    parts[0].iov_base = header;
+    parts[0].iov_len = networking::frame_header::encode(size, header);
+    parts[1].iov_base = data;
+    parts[1].iov_len = size;
+
+    std::vector<networking::udp::delivery> failed;
+    std::size_t sent = 0;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    lock_.lock();
+    thread_local std::vector<mmsghdr> datagrams;
+    datagrams.assign(destinations_.size(), mmsghdr());
+
+    for (std::size_t i = 0; i < destinations_.size(); ++i)
+    {
+        datagrams[i].msg_hdr.msg_name = &destinations_[i].connection_;
+        datagrams[i].msg_hdr.msg_namelen = sizeof(destinations_[i].connection_);
+        datagrams[i].msg_hdr.msg_iov = parts;
+        datagrams[i].msg_hdr.msg_iovlen = 2;
+    }
+
+    std::size_t next = 0;
+    while (next < datagrams.size())
+    {
+        const std::size_t batch = std::min<std::size_t>(datagrams.size() - next, UIO_MAXIOV);
+        const int result = sendmmsg(sock, datagrams.data() + next, batch, 0);
+
+        if (result < 0)
+        {
+            if (errno == EINTR) { continue; }
+
+            const int error = errno;
+            const sockaddr_in& peer = destinations_[next].connection_;
+            failed.push_back(networking::udp::delivery{address_string(peer.sin_addr), ntohs(peer.sin_port), error});
+            next += 1;
+        }
+        else
+        {
+            sent += static_cast<std::size_t>(result);
+            next += static_cast<std::size_t>(result);
+        }
+    }
+    lock_.unlock();
+
+    if (!is_big_endian()) {
+        reverse_byte_order((unsigned char* const) data, size);
+    }
+
+    const std::uint64_t latency = elapsed_ns(start);
+    for (std::size_t i = 0; i < sent; ++i) { metrics_.record_transfer(size, latency); }
+
+    for (const auto& failure : failed)
+    {
+        last_error_ = networking::error::TRANSFER_ERROR;
+        make_log(last_error_, failure.ip_address_ + ':' + std::to_string(failure.port_) + ": " + strerror(failure.error_));
+    }
+
+    make_log(networking::netbase::log::DATA_TRANSMITTED_LOG, 
+        "TX: " + std::to_string(size) + " | " + std::to_string(sent) + " of " + std::to_string(sent + failed.size()) + " peers");
+
+    if (failures != nullptr) { failures->insert(failures->end(), failed.begin(), failed.end()); }
+    return sent;
+}
+
+
 void networking::udp::receive_byte_count(const networking::socket_t& sock, std::size_t& count)
 {
     if (is_destination() && is_running())
     {
+        if (operation_timeout_.count() > 0 && !wait_for(sock, POLLIN, operation_timeout_))
+        {
+            count = 0;
+            last_error_ = networking::error::TIMEOUT_ERROR;
+            make_log(last_error_);
+            return;
+        }
+
+        unsigned char header[networking::frame_header::MAX_SIZE];
+
         lock_.lock();
-        socklen_t len =  sizeof(destination_.connection_);
-        
-        if (recvfrom(sock, &count, sizeof(count), 0, nullptr, &len) < 0)
+        const ssize_t result = recv(sock, header, sizeof(header), MSG_PEEK | MSG_TRUNC);
+        if (result < 0)
         {
             last_error_ = networking::error::RECEIVE_ERROR;
             lock_.unlock();
             const char* message = make_log(last_error_, strerror(errno)); 
             throw networking::networking_error(message);
         }
+
+        // The header is only peeked so that receive() takes the whole datagram in one call; a
+        // datagram whose header does not match its length is dropped.
+        const std::size_t header_size = (result > 0) ? networking::frame_header::size(header[0]) : 0;
+        const std::uint64_t length = (header_size > 0 && static_cast<std::size_t>(result) >= header_size) ? 
+            networking::frame_header::decode(header) : 0;
+
+        count = 0;
+        if (length == 0 || length != static_cast<std::uint64_t>(result) - header_size)
+        {
+            recv(sock, header, 0, 0);
+            lock_.unlock();
+
+            last_error_ = networking::error::RECEIVE_ERROR;
+            make_log(last_error_, "malformed datagram header");
+            return;
+        }
         lock_.unlock();
 
-        if (!is_big_endian()) { count = ntohl(count); }
+        count = static_cast<std::size_t>(length);
     }
-}
\ No newline at end of file
+}
@@ -3,6 +3,7 @@
 #include "netbase.hpp"
 #include "networking_error.hpp"
 #include <sys/socket.h>
+#include <atomic>
 #include <string>
 #include <cinttypes>
 #include <vector>
@@ -13,10 +14,19 @@ namespace networking
 {
     class udp : public netbase
     {
+        public:
+            struct delivery
+            {
+                std::string ip_address_;
+                std::uint16_t port_ = 0;
+                int error_ = 0;
+            };
+
         public:
             udp();
             udp(const std::string& ip_address, const std::uint16_t& port, 
-                const networking::communication& communication_type, const std::string& log_file_path = "");
+                const networking::communication& communication_type, const std::string& log_file_path = "", 
+                const networking::socket_options& options = networking::socket_options());
             udp(const udp& obj) = delete;
             udp(udp&& obj) = delete;
             ~udp();
@@ -29,8 +39,22 @@ namespace networking
             void end() override;
             void set_destination(const std::string& ip_address, const std::uint16_t& port);
             void unset_destination();
+            // Subscribes the bound port to a multicast group on the interface with the given
+            // address, or on the one the routing table picks. Group traffic only reaches an
+            // endpoint bound to 0.0.0.0 or to the group address. Memberships survive end() and
+            // are joined again by start().
+            void join_group(const std::string& group_ip_address, const std::string& interface_ip_address = "0.0.0.0");
+            void leave_group(const std::string& group_ip_address, const std::string& interface_ip_address = "0.0.0.0");
+            std::vector<std::string> groups() const;
+            // Destination set for transfer_all(), independent of set_destination().
+            void add_destination(const std::string& ip_address, const std::uint16_t& port);
+            void remove_destination(const std::string& ip_address, const std::uint16_t& port);
+            void clear_destinations();
+            std::size_t destinations_count() const;
             bool is_running() const override;
             bool is_data_to_receive() const;
+            bool wait_readable(const std::chrono::milliseconds& timeout = std::chrono::milliseconds(-1));
+            bool wait_writable(const std::chrono::milliseconds& timeout = std::chrono::milliseconds(-1));
             bool is_destination() const;
             std::string destination_ip_address() const;
             std::uint16_t destination_port() const;
@@ -42,13 +66,26 @@ namespace networking
             }
 
             
+            // Sends one datagram to every destination of the set with a single sendmmsg(), returning
+            // how many were sent. A peer that fails is logged and appended to failures, if given,
+            // and the remaining peers are still served.
+            template<typename T>
+            std::size_t transfer_all(T* const data, const std::size_t& count, std::vector<networking::udp::delivery>* const failures = nullptr)
+            {
+                return transfer_all(server_.socket_, data, (sizeof(T) * count), failures);
+            }
+
+            
             template<typename T, typename RT>
             RT receive()
             {
                 std::size_t count = 0;
                 receive_byte_count(server_.socket_, count);
         
-                if (count > 0)
+                if (count % sizeof(T) != 0) {
+                    reject_message(server_.socket_, count, sizeof(T));
+                }
+                else if (count > 0)
                 {
                     RT buffer(count / sizeof(T));
                     if (receive(server_.socket_, buffer.data(), count))
@@ -66,10 +103,17 @@ namespace networking
             bool receive(const networking::socket_t& sock, void* const data, const std::size_t& size) override;
             bool transfer(const networking::socket_t& sock, void* const data, const std::size_t& size) override;
             void receive_byte_count(const networking::socket_t& sock, std::size_t& count) override;
+            bool make_membership(const std::string& group_ip_address, const std::string& interface_ip_address, 
+                ip_mreq& membership) const;
+            std::size_t transfer_all(const networking::socket_t& sock, void* const data, const std::size_t& size, 
+                std::vector<networking::udp::delivery>* const failures);
+            bool make_address(const std::string& ip_address, const std::uint16_t& port, sockaddr_in& address) const;
 
 
         private:
-            bool is_destination_ = false;
+            std::atomic<bool> is_destination_ = false;
+            std::vector<networking::netbase::connection> destinations_;
+            std::vector<ip_mreq> groups_;
             networking::netbase::connection destination_;
     };
 }
@@ -82,13 +126,21 @@ inline bool networking::udp::is_destination() const
 
 inline std::string networking::udp::destination_ip_address() const
 {
-    return inet_ntoa(destination_.connection_.sin_addr);
+    std::shared_lock<std::shared_mutex> lock(lock_);
+    return address_string(destination_.connection_.sin_addr);
 }
 
 inline std::uint16_t networking::udp::destination_port() const
 {
+    std::shared_lock<std::shared_mutex> lock(lock_);
     return ntohs(destination_.connection_.sin_port);
 }
 
+inline std::size_t networking::udp::destinations_count() const
+{
+    std::shared_lock<std::shared_mutex> lock(lock_);
+    return destinations_.size();
+}
+
 
 #endif
\ No newline at end of file